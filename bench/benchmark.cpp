@@ -0,0 +1,338 @@
+#include "benchmark.hpp"
+#include <fmt/format.h>
+#include <numeric>
+
+namespace
+{
+    double median(std::vector<double> values)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+
+        std::sort(values.begin(), values.end());
+        const size_t middle = values.size() / 2;
+        return values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+    }
+
+    std::vector<std::string> split(const std::string &value, const char delimiter)
+    {
+        std::vector<std::string> parts;
+        std::stringstream stream(value);
+        std::string part;
+
+        while (std::getline(stream, part, delimiter))
+        {
+            if (!part.empty())
+            {
+                parts.push_back(part);
+            }
+        }
+
+        return parts;
+    }
+
+    std::string escape(const std::string &value)
+    {
+        std::string escaped;
+
+        for (const char character : value)
+        {
+            if (character == '"' || character == '\\')
+            {
+                escaped.push_back('\\');
+            }
+
+            escaped.push_back(character);
+        }
+
+        return escaped;
+    }
+
+    const char *usage = "Usage: voxel-blaze-bench [--warmup N] [--repetitions N] [--sizes 16,32,...] "
+                        "[--groups fill,mesh,lod,label,snapshot,optimize,pipeline,cache,world,load,startup,export] "
+                        "[--filter TEXT] [--output FILE] [--memory on|off] [--perf on|off] [--profile FILE] [--seed N]";
+}
+
+BenchmarkOptions BenchmarkOptions::parse(int argc, char **argv)
+{
+    BenchmarkOptions options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+
+        if (argument == "--help")
+        {
+            throw std::runtime_error(usage);
+        }
+
+        if (i + 1 >= argc)
+        {
+            throw std::runtime_error(fmt::format("Missing value for `{}`\n{}", argument, usage));
+        }
+
+        const std::string value = argv[++i];
+
+        if (argument == "--warmup")
+        {
+            options.warmup = std::stoul(value);
+        }
+        else if (argument == "--repetitions")
+        {
+            options.repetitions = std::max(1ul, std::stoul(value));
+        }
+        else if (argument == "--sizes")
+        {
+            options.sizes.clear();
+            for (const auto &size : split(value, ','))
+            {
+                options.sizes.push_back(std::stoul(size));
+            }
+        }
+        else if (argument == "--groups")
+        {
+            options.groups = split(value, ',');
+        }
+        else if (argument == "--filter")
+        {
+            options.filter = value;
+        }
+        else if (argument == "--output")
+        {
+            options.output = value;
+        }
+        else if (argument == "--memory")
+        {
+            options.memory = value != "off";
+        }
+        else if (argument == "--perf")
+        {
+            options.perf = value != "off";
+        }
+        else if (argument == "--profile")
+        {
+            options.profile = value;
+        }
+        else if (argument == "--seed")
+        {
+            options.seed = std::stoull(value);
+        }
+        else
+        {
+            throw std::runtime_error(fmt::format("Unknown argument `{}`\n{}", argument, usage));
+        }
+    }
+
+    return options;
+}
+
+bool BenchmarkOptions::has_group(const std::string &group) const
+{
+    return std::find(groups.begin(), groups.end(), group) != groups.end();
+}
+
+void BenchmarkResult::add_per_voxel_counters(const size_t voxel_count)
+{
+    if (voxel_count == 0)
+    {
+        return;
+    }
+
+    if (median_ns > 0)
+    {
+        add_counter("voxels_per_s", voxel_count / (median_ns / 1e9));
+    }
+
+    if (perf.available[PerfStats::CacheMisses])
+    {
+        add_counter("cache_misses_per_voxel", perf.values[PerfStats::CacheMisses] / voxel_count);
+    }
+
+    if (perf.available[PerfStats::BranchMisses])
+    {
+        add_counter("branch_misses_per_voxel", perf.values[PerfStats::BranchMisses] / voxel_count);
+    }
+}
+
+Benchmark::Benchmark(const BenchmarkOptions &options) : options(options)
+{
+    if (options.perf)
+    {
+        perf_counters = std::make_unique<PerfCounters>();
+    }
+}
+
+bool Benchmark::enabled(const std::string &name) const
+{
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+}
+
+BenchmarkResult &Benchmark::run(const std::string &name,
+                                const std::vector<std::pair<std::string, std::string>> &parameters,
+                                const std::function<void()> &function)
+{
+    for (unsigned i = 0; i < options.warmup; i++)
+    {
+        function();
+    }
+
+    std::vector<double> durations;
+    durations.reserve(options.repetitions);
+    Timer timer;
+    PerfStats perf;
+
+    for (unsigned i = 0; i < options.repetitions; i++)
+    {
+        if (perf_counters)
+        {
+            perf_counters->start();
+        }
+
+        timed = true;
+        timer.start();
+        function();
+        durations.push_back(timer.round().count());
+        timed = false;
+
+        if (perf_counters)
+        {
+            perf += perf_counters->stop();
+        }
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.parameters = parameters;
+    result.repetitions = options.repetitions;
+    result.median_ns = median(durations);
+    result.min_ns = *std::min_element(durations.begin(), durations.end());
+    result.max_ns = *std::max_element(durations.begin(), durations.end());
+    result.mean_ns = std::accumulate(durations.begin(), durations.end(), 0.0) / durations.size();
+
+    // Median absolute deviation, robust against single outliers.
+    std::vector<double> deviations;
+    for (const auto duration : durations)
+    {
+        deviations.push_back(std::fabs(duration - result.median_ns));
+    }
+
+    result.mad_ns = median(deviations);
+
+    // Counters are averaged over the timed runs.
+    for (size_t i = 0; i < PerfStats::CounterCount; i++)
+    {
+        result.perf.available[i] = perf.available[i];
+        result.perf.values[i] = perf.values[i] / options.repetitions;
+
+        if (perf.available[i])
+        {
+            result.add_counter(PerfStats::name(static_cast<PerfStats::Counter>(i)), result.perf.values[i]);
+        }
+    }
+
+    if (perf.available[PerfStats::Cycles] && perf.available[PerfStats::Instructions] &&
+        perf.values[PerfStats::Cycles] > 0)
+    {
+        result.add_counter("ipc", perf.values[PerfStats::Instructions] / perf.values[PerfStats::Cycles]);
+    }
+
+    // Memory is measured in a separate run, so the timed runs stay free of the sampling.
+    if (options.memory)
+    {
+        MemoryScope scope;
+        function();
+        result.memory = scope.stop();
+
+        result.add_counter("allocations", result.memory.allocations);
+        result.add_counter("allocated_bytes", result.memory.allocated_bytes);
+        result.add_counter("peak_heap_bytes", result.memory.peak_heap_bytes);
+        result.add_counter("peak_rss_growth_bytes", result.memory.peak_rss_growth_bytes);
+    }
+
+    results.push_back(result);
+    return results.back();
+}
+
+bool Benchmark::timing() const
+{
+    return timed;
+}
+
+void Benchmark::print(const BenchmarkResult &result) const
+{
+    fmt::print("{:<48} median {:>12} mad {:>12} min {:>12}", result.name, Timer::format_duration(result.median_ns),
+               Timer::format_duration(result.mad_ns), Timer::format_duration(result.min_ns));
+
+    for (const auto &[key, value] : result.counters)
+    {
+        fmt::print("  {} {:.10g}", key, value);
+    }
+
+    fmt::print("\n");
+}
+
+void Benchmark::write_json(const std::string &path) const
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+
+    fmt::memory_buffer buffer;
+    auto out = fmt::appender(buffer);
+
+    fmt::format_to(out, "{{\n  \"version\": 1,\n  \"warmup\": {},\n  \"repetitions\": {},\n  \"results\": [",
+                   options.warmup, options.repetitions);
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto &result = results[i];
+        fmt::format_to(out, "{}\n    {{\"name\": \"{}\"", i == 0 ? "" : ",", escape(result.name));
+
+        for (const auto &[key, value] : result.parameters)
+        {
+            fmt::format_to(out, ", \"{}\": \"{}\"", escape(key), escape(value));
+        }
+
+        fmt::format_to(out,
+                       ", \"repetitions\": {}, \"median_ns\": {}, \"mad_ns\": {}, \"min_ns\": {}, \"mean_ns\": {}, "
+                       "\"max_ns\": {}, \"counters\": {{",
+                       result.repetitions, result.median_ns, result.mad_ns, result.min_ns, result.mean_ns,
+                       result.max_ns);
+
+        for (size_t j = 0; j < result.counters.size(); j++)
+        {
+            fmt::format_to(out, "{}\"{}\": {}", j == 0 ? "" : ", ", escape(result.counters[j].first),
+                           result.counters[j].second);
+        }
+
+        fmt::format_to(out, "}}}}");
+    }
+
+    fmt::format_to(out, "\n  ]\n}}\n");
+    file.write(buffer.data(), buffer.size());
+    file.close();
+
+    spdlog::info("Wrote {} benchmark results to `{}`", results.size(), path);
+}
+
+std::string Timer::format_duration(double ns_count)
+{
+    if (ns_count < 1000)
+    {
+        return fmt::format("{:.0f}ns", ns_count);
+    }
+    else if (ns_count < 1000 * 1000)
+    {
+        return fmt::format("{:.3f}µs", ns_count / 1000.0);
+    }
+    else if (ns_count < 1000 * 1000 * 1000)
+    {
+        return fmt::format("{:.3f}ms", ns_count / (1000.0 * 1000.0));
+    }
+
+    return fmt::format("{:.3f}s", ns_count / (1000.0 * 1000.0 * 1000.0));
+}
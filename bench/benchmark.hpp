@@ -0,0 +1,84 @@
+#pragma once
+
+#include "memory.hpp"
+#include "perf_counters.hpp"
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/scenes.hpp>
+
+struct BenchmarkOptions
+{
+    unsigned warmup = 1;
+    unsigned repetitions = 5;
+    std::vector<unsigned> sizes = {16, 32, 64, 128};
+    std::vector<std::string> groups = {"fill",     "mesh",  "lod",   "label", "snapshot", "optimize",
+                                       "pipeline", "cache", "world", "load",  "startup",  "export"};
+    std::string filter;
+    std::string output = "benchmark.json";
+    bool memory = true;
+    bool perf = true;
+    std::string profile;
+    uint64_t seed = SceneLibrary::default_seed;
+
+    static BenchmarkOptions parse(int argc, char **argv);
+    bool has_group(const std::string &group) const;
+};
+
+struct BenchmarkResult
+{
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> parameters;
+    unsigned repetitions = 0;
+    double median_ns = 0;
+    double mad_ns = 0;
+    double min_ns = 0;
+    double mean_ns = 0;
+    double max_ns = 0;
+    MemoryStats memory;
+    PerfStats perf;
+    std::vector<std::pair<std::string, double>> counters;
+
+    inline void add_counter(const std::string &key, const double value)
+    {
+        counters.push_back({key, value});
+    }
+
+    void add_per_voxel_counters(const size_t voxel_count);
+};
+
+class Benchmark
+{
+  public:
+    Benchmark(const BenchmarkOptions &options);
+    bool enabled(const std::string &name) const;
+    BenchmarkResult &run(const std::string &name, const std::vector<std::pair<std::string, std::string>> &parameters,
+                         const std::function<void()> &function);
+    // True while `run` executes one of the timed repetitions, functions that collect their own samples skip the warmup
+    // and memory runs with it.
+    bool timing() const;
+    void print(const BenchmarkResult &result) const;
+    void write_json(const std::string &path) const;
+
+  private:
+    const BenchmarkOptions options;
+    std::unique_ptr<PerfCounters> perf_counters;
+    std::vector<BenchmarkResult> results;
+    bool timed = false;
+};
+
+struct Timer
+{
+    std::chrono::steady_clock::time_point start_point = std::chrono::steady_clock::now();
+
+    inline void start()
+    {
+        start_point = std::chrono::steady_clock::now();
+    }
+
+    inline std::chrono::nanoseconds round() const
+    {
+        auto end_point = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end_point - start_point);
+    }
+
+    static std::string format_duration(double ns_count);
+};
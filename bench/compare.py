@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Compares two voxel-blaze-bench JSON reports and flags regressions of the median run time.
+
+A result counts as regressed when its median is slower than the baseline by more than the relative threshold and
+the difference also exceeds three times the larger median absolute deviation, so noisy results are not flagged.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as file:
+        return {result["name"]: result for result in json.load(file)["results"]}
+
+
+def format_duration(ns):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("µs", 1e3)):
+        if ns >= scale:
+            return f"{ns / scale:.3f}{unit}"
+    return f"{ns:.0f}ns"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline", help="stored baseline report")
+    parser.add_argument("current", help="report of the current build")
+    parser.add_argument("--threshold", type=float, default=0.05, help="relative slowdown to flag (default 0.05)")
+    arguments = parser.parse_args()
+
+    baseline = load(arguments.baseline)
+    current = load(arguments.current)
+    regressions = 0
+
+    for name in sorted(current.keys() & baseline.keys()):
+        old, new = baseline[name], current[name]
+        difference = new["median_ns"] - old["median_ns"]
+        change = difference / old["median_ns"] if old["median_ns"] > 0 else 0.0
+        noise = 3.0 * max(old["mad_ns"], new["mad_ns"])
+
+        status = ""
+        if change > arguments.threshold and difference > noise:
+            status = "REGRESSION"
+            regressions += 1
+        elif change < -arguments.threshold and -difference > noise:
+            status = "improvement"
+
+        print(f"{name:<48} {format_duration(old['median_ns']):>12} {format_duration(new['median_ns']):>12} "
+              f"{change * 100.0:+8.2f}% {status}")
+
+    for name in sorted(current.keys() - baseline.keys()):
+        print(f"{name:<48} {'':>12} {format_duration(current[name]['median_ns']):>12} {'new':>9}")
+
+    for name in sorted(baseline.keys() - current.keys()):
+        print(f"{name:<48} {format_duration(baseline[name]['median_ns']):>12} {'':>12} {'missing':>9}")
+
+    print(f"\n{regressions} regression(s) above {arguments.threshold * 100.0:.1f}%")
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
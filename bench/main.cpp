@@ -0,0 +1,984 @@
+#include "benchmark.hpp"
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <voxel-blaze/chunk_world.hpp>
+#include <voxel-blaze/hash.hpp>
+#include <voxel-blaze/mesh_cache.hpp>
+#include <voxel-blaze/mesh_pipeline.hpp>
+#include <voxel-blaze/parsers/vbz_cache.hpp>
+#include <voxel-blaze/parsers/vox_parser.hpp>
+#include <voxel-blaze/profiler.hpp>
+#include <voxel-blaze/scenes.hpp>
+#include <voxel-blaze/voxels/array_voxel_grid.hpp>
+#include <voxel-blaze/voxels/components.hpp>
+#include <voxel-blaze/voxels/lod_pyramid.hpp>
+#include <voxel-blaze/voxels/palette_voxel_grid.hpp>
+#include <voxel-blaze/voxels/rle_column_voxel_grid.hpp>
+#include <voxel-blaze/voxels/sparse_voxel_grid.hpp>
+
+using Parameters = std::vector<std::pair<std::string, std::string>>;
+
+const std::vector<std::pair<std::string, std::function<std::unique_ptr<VoxelGrid>(glm::uvec3)>>> backends = {
+    {"array", [](glm::uvec3 size) { return std::make_unique<ArrayVoxelGrid>(size.x, size.y, size.z); }},
+    {"array-tiled",
+     [](glm::uvec3 size) {
+         return std::make_unique<ArrayVoxelGrid>(size.x, size.y, size.z, ArrayVoxelGrid::Layout::Tiled);
+     }},
+    {"palette", [](glm::uvec3 size) { return std::make_unique<PaletteVoxelGrid>(size.x, size.y, size.z); }},
+    {"sparse", [](glm::uvec3 size) { return std::make_unique<SparseVoxelGrid>(size.x, size.y, size.z); }},
+    {"rle", [](glm::uvec3 size) { return std::make_unique<RleColumnVoxelGrid>(size.x, size.y, size.z); }},
+};
+
+// File scenes run once at the size of their model, generated scenes at every requested size.
+std::vector<glm::uvec3> scene_sizes(const Scene &scene, const BenchmarkOptions &options)
+{
+    if (scene.is_file())
+    {
+        return {scene.get_size(0)};
+    }
+
+    std::vector<glm::uvec3> sizes;
+    for (const auto size : options.sizes)
+    {
+        sizes.push_back(glm::uvec3(size));
+    }
+
+    return sizes;
+}
+
+std::string size_label(const glm::uvec3 &size)
+{
+    return size.x == size.y && size.y == size.z ? std::to_string(size.x)
+                                                : fmt::format("{}x{}x{}", size.x, size.y, size.z);
+}
+
+const std::vector<std::pair<std::string, std::function<Mesh(const VoxelGrid &)>>> meshers = {
+    {"direct", &VoxelGrid::meshify_direct},
+    {"culled", &VoxelGrid::meshify_culled},
+    {"greedy", &VoxelGrid::meshify_greedy},
+    {"culled-exterior", &VoxelGrid::meshify_culled_exterior},
+    {"greedy-exterior", &VoxelGrid::meshify_greedy_exterior},
+};
+
+void mesh_group(Benchmark &benchmark, const BenchmarkOptions &options, const SceneLibrary &library)
+{
+    for (const auto &scene : library.get_scenes())
+    {
+        const auto &scene_name = scene.name;
+
+        for (const auto size : scene_sizes(scene, options))
+        {
+            for (const auto &[backend_name, create] : backends)
+            {
+                const auto prefix = fmt::format("mesh/{}/{}/{}/", scene_name, size_label(size), backend_name);
+                std::unique_ptr<VoxelGrid> grid;
+
+                for (const auto &mesher : meshers)
+                {
+                    const auto &mesher_name = mesher.first;
+                    const auto &meshify = mesher.second;
+                    const auto name = prefix + mesher_name;
+                    if (!benchmark.enabled(name))
+                    {
+                        continue;
+                    }
+
+                    if (!grid)
+                    {
+                        grid = create(size);
+                        scene.fill(*grid);
+                    }
+
+                    Mesh mesh;
+                    auto &result = benchmark.run(
+                        name,
+                        {{"scene", scene_name},
+                         {"seed", std::to_string(options.seed)},
+                         {"size", size_label(size)},
+                         {"backend", backend_name},
+                         {"mesher", mesher_name}},
+                        [&]() { mesh = meshify(*grid); });
+
+                    result.add_counter("vertices", mesh.vertices.size());
+                    result.add_counter("faces", mesh.indices.size() / 3);
+                    result.add_counter("gpu_bytes", mesh.view().gpu_bytes());
+
+                    result.add_per_voxel_counters(size_t(size.x) * size.y * size.z);
+
+                    if (options.memory && !mesh.vertices.empty())
+                    {
+                        result.add_counter("peak_heap_bytes_per_vertex",
+                                           double(result.memory.peak_heap_bytes) / mesh.vertices.size());
+                    }
+                    benchmark.print(result);
+                }
+            }
+        }
+    }
+}
+
+void fill_group(Benchmark &benchmark, const BenchmarkOptions &options, const SceneLibrary &library)
+{
+    for (const auto &scene : library.get_scenes())
+    {
+        // Reading files is measured by the load group.
+        if (scene.is_file())
+        {
+            continue;
+        }
+
+        const auto &scene_name = scene.name;
+
+        for (const auto size : scene_sizes(scene, options))
+        {
+            for (const auto &backend : backends)
+            {
+                const auto &backend_name = backend.first;
+                const auto name = fmt::format("fill/{}/{}/{}", scene_name, size_label(size), backend_name);
+                if (!benchmark.enabled(name))
+                {
+                    continue;
+                }
+
+                // Fills only write voxels, so refilling the same grid repeats the same work.
+                const auto grid = backend.second(size);
+                auto &result = benchmark.run(
+                    name,
+                    {{"scene", scene_name},
+                     {"seed", std::to_string(options.seed)},
+                     {"size", size_label(size)},
+                     {"backend", backend_name}},
+                    [&]() { scene.fill(*grid); });
+
+                result.add_per_voxel_counters(size_t(size.x) * size.y * size.z);
+
+                // Compared against the dense array layout of the same grid.
+                if (const auto rle = dynamic_cast<const RleColumnVoxelGrid *>(grid.get()))
+                {
+                    result.add_counter("runs", rle->run_count());
+                    result.add_counter("compression_ratio", double(size_t(size.x) * size.y * size.z *
+                                                                   sizeof(std::optional<Voxel>)) /
+                                                                rle->storage_bytes());
+                }
+                benchmark.print(result);
+            }
+        }
+    }
+}
+
+void lod_group(Benchmark &benchmark, const BenchmarkOptions &options, const SceneLibrary &library)
+{
+    for (const auto &scene : library.get_scenes())
+    {
+        for (const auto size : scene_sizes(scene, options))
+        {
+            const auto prefix = fmt::format("lod/{}/{}/", scene.name, size_label(size));
+            ArrayVoxelGrid grid(size.x, size.y, size.z);
+            scene.fill(grid);
+
+            if (benchmark.enabled(prefix + "build"))
+            {
+                auto &result = benchmark.run(prefix + "build", {{"scene", scene.name}, {"size", size_label(size)}},
+                                             [&]() { LodPyramid pyramid(grid); });
+                benchmark.print(result);
+            }
+
+            const LodPyramid pyramid(grid);
+
+            for (size_t level = 0; level < pyramid.level_count(); level++)
+            {
+                const auto &level_grid = pyramid.get_level(level);
+                const auto level_size = level_grid.get_size();
+
+                // The direct mesher ignores neighbours, coarser levels would not change its relative cost.
+                for (const auto &[mesher_name, meshify] : meshers)
+                {
+                    const auto name = fmt::format("{}{}/{}", prefix, level, mesher_name);
+                    if (mesher_name == "direct" || !benchmark.enabled(name))
+                    {
+                        continue;
+                    }
+
+                    Mesh mesh;
+                    auto &result = benchmark.run(name,
+                                                 {{"scene", scene.name},
+                                                  {"size", size_label(size)},
+                                                  {"level", std::to_string(level)},
+                                                  {"mesher", mesher_name}},
+                                                 [&]() { mesh = meshify(level_grid); });
+
+                    result.add_counter("vertices", mesh.vertices.size());
+                    result.add_counter("faces", mesh.indices.size() / 3);
+                    result.add_per_voxel_counters(size_t(level_size.x) * level_size.y * level_size.z);
+                    benchmark.print(result);
+                }
+            }
+        }
+    }
+}
+
+void label_group(Benchmark &benchmark, const BenchmarkOptions &options, const SceneLibrary &library)
+{
+    // Large noise volumes hold many runs per row, palette grids keep the 512^3 case within memory.
+    const auto &scene = library.get_scene("noise");
+    const std::vector<std::pair<std::string, Connectivity>> connectivities = {{"face", Connectivity::Face},
+                                                                              {"full", Connectivity::Full}};
+
+    for (const unsigned size : {256u, 512u})
+    {
+        const auto prefix = fmt::format("label/{}/{}/", scene.name, size);
+        std::unique_ptr<PaletteVoxelGrid> grid;
+
+        for (const auto &[connectivity_name, connectivity] : connectivities)
+        {
+            const auto name = prefix + connectivity_name;
+            if (!benchmark.enabled(name))
+            {
+                continue;
+            }
+
+            if (!grid)
+            {
+                grid = std::make_unique<PaletteVoxelGrid>(size, size, size);
+                scene.fill(*grid);
+            }
+
+            size_t component_count = 0;
+            size_t run_count = 0;
+            auto &result = benchmark.run(name,
+                                         {{"scene", scene.name},
+                                          {"seed", std::to_string(options.seed)},
+                                          {"size", std::to_string(size)},
+                                          {"connectivity", connectivity_name}},
+                                         [&]() {
+                                             const ComponentLabeling labeling(*grid, connectivity);
+                                             component_count = labeling.get_components().size();
+                                             run_count = labeling.run_count();
+                                         });
+
+            result.add_counter("components", component_count);
+            result.add_counter("runs", run_count);
+            result.add_per_voxel_counters(size_t(size) * size * size);
+            benchmark.print(result);
+        }
+    }
+}
+
+void snapshot_group(Benchmark &benchmark, const BenchmarkOptions &options, const SceneLibrary &library)
+{
+    const auto &scene = library.get_scene("noise");
+    const Voxel edit_voxel = {1.0f, 0.0f, 0.0f};
+
+    for (const auto size : options.sizes)
+    {
+        const auto prefix = fmt::format("snapshot/{}/{}/", scene.name, size);
+        SparseVoxelGrid grid(size, size, size);
+        scene.fill(grid);
+
+        if (benchmark.enabled(prefix + "take"))
+        {
+            auto &result = benchmark.run(prefix + "take", {{"scene", scene.name}, {"size", std::to_string(size)}},
+                                         [&]() { const auto snapshot = grid.snapshot(); });
+            result.add_counter("chunks", grid.chunk_count());
+            benchmark.print(result);
+        }
+
+        // Meshes a fresh snapshot, optionally while another thread keeps editing the grid it was taken from.
+        for (const bool concurrent : {false, true})
+        {
+            const auto name = prefix + (concurrent ? "mesh-concurrent" : "mesh");
+            if (!benchmark.enabled(name))
+            {
+                continue;
+            }
+
+            size_t edit_count = 0;
+            double mesh_ns = 0;
+            uint64_t edit_hash = options.seed;
+            Mesh mesh;
+
+            auto &result = benchmark.run(
+                name,
+                {{"scene", scene.name}, {"size", std::to_string(size)}, {"concurrent", concurrent ? "on" : "off"}},
+                [&]() {
+                    const auto snapshot = grid.snapshot();
+                    std::atomic<bool> done = false;
+                    std::thread writer;
+
+                    if (concurrent)
+                    {
+                        writer = std::thread([&]() {
+                            while (!done.load(std::memory_order_relaxed))
+                            {
+                                edit_hash = hash_mix(edit_hash);
+                                const unsigned x = edit_hash % size;
+                                const unsigned y = (edit_hash >> 20) % size;
+                                const unsigned z = (edit_hash >> 40) % size;
+                                // Every edit is undone again, so all repetitions mesh the same scene.
+                                const auto previous = grid.get_voxel(x, y, z);
+                                grid.set_voxel(x, y, z, previous.has_value() ? std::nullopt
+                                                                             : std::optional<Voxel>(edit_voxel));
+                                grid.set_voxel(x, y, z, previous);
+                                edit_count += 2;
+                            }
+                        });
+                    }
+
+                    const Timer timer;
+                    mesh = snapshot->meshify_greedy();
+                    mesh_ns += timer.round().count();
+
+                    done = true;
+                    if (writer.joinable())
+                    {
+                        writer.join();
+                    }
+                });
+
+            result.add_counter("faces", mesh.indices.size() / 3);
+            if (concurrent && mesh_ns > 0)
+            {
+                result.add_counter("edits_per_s", edit_count / (mesh_ns / 1e9));
+            }
+
+            result.add_per_voxel_counters(size_t(size) * size * size);
+            benchmark.print(result);
+        }
+    }
+}
+
+void optimize_group(Benchmark &benchmark, const BenchmarkOptions &options, const SceneLibrary &library)
+{
+    // Times the vertex cache and fetch reordering of culled and greedy meshes, including a copy of the mesh per run.
+    const std::vector<std::pair<std::string, std::function<Mesh(const VoxelGrid &)>>> optimized_meshers = {
+        {"culled", &VoxelGrid::meshify_culled},
+        {"greedy", &VoxelGrid::meshify_greedy},
+    };
+
+    for (const auto &scene : library.get_scenes())
+    {
+        for (const auto size : scene_sizes(scene, options))
+        {
+            std::unique_ptr<PaletteVoxelGrid> grid;
+
+            for (const auto &[mesher_name, meshify] : optimized_meshers)
+            {
+                const auto name = fmt::format("optimize/{}/{}/{}", scene.name, size_label(size), mesher_name);
+                if (!benchmark.enabled(name))
+                {
+                    continue;
+                }
+
+                if (!grid)
+                {
+                    grid = std::make_unique<PaletteVoxelGrid>(size.x, size.y, size.z);
+                    scene.fill(*grid);
+                }
+
+                const auto mesh = meshify(*grid);
+                Mesh optimized;
+                auto &result = benchmark.run(name,
+                                             {{"scene", scene.name},
+                                              {"seed", std::to_string(options.seed)},
+                                              {"size", size_label(size)},
+                                              {"mesher", mesher_name}},
+                                             [&]() {
+                                                 optimized = mesh;
+                                                 optimized.optimize();
+                                             });
+
+                const auto before = mesh.analyze_vertex_cache();
+                const auto after = optimized.analyze_vertex_cache();
+                const size_t triangle_count = mesh.indices.size() / 3;
+                result.add_counter("triangles", triangle_count);
+                result.add_counter("acmr_before", before.acmr);
+                result.add_counter("acmr_after", after.acmr);
+                result.add_counter("atvr_before", before.atvr);
+                result.add_counter("atvr_after", after.atvr);
+                result.add_counter("triangles_per_s", triangle_count / (result.median_ns / 1e9));
+                benchmark.print(result);
+            }
+        }
+    }
+}
+
+void pipeline_group(Benchmark &benchmark, const BenchmarkOptions &options, const SceneLibrary &library)
+{
+    // Simulated frames upload finished meshes into staging memory and then wait out the rest of a fixed frame time,
+    // standing in for the draw and swap of the render loop.
+    const auto frame_interval = std::chrono::milliseconds(4);
+    const auto upload_budget = std::chrono::milliseconds(2);
+    const unsigned remesh_count = 8;
+    const auto &scene = library.get_scene("noise");
+
+    for (const auto size : options.sizes)
+    {
+        const auto grid = std::make_shared<ArrayVoxelGrid>(size, size, size);
+        scene.fill(*grid);
+
+        for (const bool async : {false, true})
+        {
+            const auto name = fmt::format("pipeline/{}/{}/{}", scene.name, size, async ? "async" : "sync");
+            if (!benchmark.enabled(name))
+            {
+                continue;
+            }
+
+            std::vector<double> frame_ms;
+            std::vector<Vertex> staged_vertices;
+            std::vector<unsigned> staged_indices;
+
+            const auto upload = [&](const Mesh &mesh) {
+                staged_vertices.assign(mesh.vertices.begin(), mesh.vertices.end());
+                staged_indices.assign(mesh.indices.begin(), mesh.indices.end());
+            };
+
+            const auto meshify = [grid]() { return std::make_shared<const Mesh>(grid->meshify_greedy()); };
+            const auto consume = [&](uint64_t, const std::shared_ptr<const Mesh> &mesh) { upload(*mesh); };
+
+            auto &result = benchmark.run(
+                name, {{"scene", scene.name}, {"size", std::to_string(size)}, {"mode", async ? "async" : "sync"}},
+                [&]() {
+                    MeshPipeline pipeline;
+                    unsigned requested = 0;
+                    unsigned uploaded = 0;
+
+                    // One remesh request every frame until all are queued, then frames go on until all are uploaded.
+                    while (uploaded < remesh_count)
+                    {
+                        const Timer timer;
+
+                        if (requested < remesh_count)
+                        {
+                            if (async)
+                            {
+                                pipeline.request(requested, meshify);
+                            }
+                            else
+                            {
+                                upload(grid->meshify_greedy());
+                                uploaded++;
+                            }
+                            requested++;
+                        }
+
+                        if (async)
+                        {
+                            uploaded += pipeline.drain(upload_budget, consume);
+                        }
+
+                        const auto elapsed = timer.round();
+                        if (elapsed < frame_interval)
+                        {
+                            std::this_thread::sleep_for(frame_interval - elapsed);
+                        }
+
+                        if (benchmark.timing())
+                        {
+                            frame_ms.push_back(timer.round().count() / 1e6);
+                        }
+                    }
+                });
+
+            // Frame times over all timed repetitions, a flat distribution means meshing never blocked a frame.
+            std::sort(frame_ms.begin(), frame_ms.end());
+            const auto percentile = [&](const double p) { return frame_ms[size_t(p * (frame_ms.size() - 1))]; };
+            result.add_counter("frames", frame_ms.size());
+            result.add_counter("frame_p50_ms", percentile(0.5));
+            result.add_counter("frame_p90_ms", percentile(0.9));
+            result.add_counter("frame_p99_ms", percentile(0.99));
+            result.add_counter("frame_max_ms", frame_ms.back());
+            benchmark.print(result);
+        }
+    }
+}
+
+void cache_group(Benchmark &benchmark, const BenchmarkOptions &options, const SceneLibrary &library)
+{
+    // Every scene is split into 32^3 chunks that are meshed one by one, once directly and once through a fresh mesh
+    // cache, so the hit rate counts chunks that repeat within the scene.
+    const unsigned chunk_size = 32;
+
+    for (const auto &scene : library.get_scenes())
+    {
+        for (const auto size : scene_sizes(scene, options))
+        {
+            const auto chunk_counts = (size + chunk_size - 1u) / chunk_size;
+            std::vector<std::unique_ptr<PaletteVoxelGrid>> chunks;
+
+            for (const bool cached : {false, true})
+            {
+                const auto mode = cached ? "cached" : "direct";
+                const auto name = fmt::format("cache/{}/{}/{}", scene.name, size_label(size), mode);
+                if (!benchmark.enabled(name))
+                {
+                    continue;
+                }
+
+                if (chunks.empty())
+                {
+                    PaletteVoxelGrid grid(size.x, size.y, size.z);
+                    scene.fill(grid);
+
+                    for (unsigned z = 0; z < chunk_counts.z; z++)
+                    {
+                        for (unsigned y = 0; y < chunk_counts.y; y++)
+                        {
+                            for (unsigned x = 0; x < chunk_counts.x; x++)
+                            {
+                                const auto origin = glm::uvec3(x, y, z) * chunk_size;
+                                auto chunk = std::make_unique<PaletteVoxelGrid>(chunk_size, chunk_size, chunk_size);
+                                chunk->fill_function([&](unsigned cx, unsigned cy, unsigned cz) {
+                                    return grid.get_voxel(origin.x + cx, origin.y + cy, origin.z + cz);
+                                });
+                                chunks.push_back(std::move(chunk));
+                            }
+                        }
+                    }
+                }
+
+                MeshCache::Stats stats;
+                size_t vertices = 0;
+                auto &result = benchmark.run(name,
+                                             {{"scene", scene.name},
+                                              {"seed", std::to_string(options.seed)},
+                                              {"size", size_label(size)},
+                                              {"mode", mode}},
+                                             [&]() {
+                                                 MeshCache cache;
+                                                 vertices = 0;
+
+                                                 for (const auto &chunk : chunks)
+                                                 {
+                                                     const auto meshify = [&]() { return chunk->meshify_greedy(); };
+                                                     vertices += cached ? cache.get(MeshCache::calculate_key(*chunk),
+                                                                                    meshify)->vertices.size()
+                                                                        : meshify().vertices.size();
+                                                 }
+
+                                                 stats = cache.get_stats();
+                                             });
+
+                result.add_counter("chunks", chunks.size());
+                result.add_counter("vertices", vertices);
+
+                if (cached)
+                {
+                    result.add_counter("hit_rate", double(stats.hits) / chunks.size());
+                    result.add_counter("unique_meshes", stats.entries);
+                    result.add_counter("cache_bytes", stats.bytes);
+                    result.add_counter("saved_bytes", stats.saved_bytes);
+                    result.add_counter("saved_mesh_ms", stats.saved_time.count() / 1e6);
+                }
+
+                result.add_per_voxel_counters(size_t(size.x) * size.y * size.z);
+                benchmark.print(result);
+            }
+        }
+    }
+}
+
+void world_group(Benchmark &benchmark)
+{
+    // The camera flies over an endless terrain at a fixed speed, budgets small enough that chunks behind it are
+    // evicted while new ones stream in. Uploads copy into staging memory like the pipeline group.
+    const auto frame_interval = std::chrono::milliseconds(4);
+    const unsigned frame_count = 600;
+    const float speed = 2.0f;
+    const auto name = "world/terrain/32";
+    if (!benchmark.enabled(name))
+    {
+        return;
+    }
+
+    ChunkWorld::Settings settings;
+    settings.chunk_size = 32;
+    settings.view_radius = 4.0f;
+    settings.cpu_budget_bytes = size_t(8) << 20;
+    settings.gpu_budget_bytes = size_t(4) << 20;
+
+    const auto generate = [size = settings.chunk_size](const glm::ivec3 &chunk, VoxelGrid &grid) {
+        const glm::ivec3 origin = chunk * int(size);
+        std::vector<int> heights(size * size);
+
+        for (unsigned z = 0; z < size; z++)
+        {
+            for (unsigned x = 0; x < size; x++)
+            {
+                const glm::vec3 position = glm::vec3(origin.x + int(x), origin.z + int(z), 0.0f) * 0.01f;
+                heights[z * size + x] = int(24.0f + 40.0f * glm::perlin(position));
+            }
+        }
+
+        grid.fill_function([&](unsigned x, unsigned y, unsigned z) -> std::optional<Voxel> {
+            const int height = heights[z * size + x] - (origin.y + int(y));
+            if (height <= 0)
+            {
+                return std::nullopt;
+            }
+
+            return height == 1 ? Voxel{0.35f, 0.70f, 0.25f} : Voxel{0.50f, 0.35f, 0.20f};
+        });
+    };
+
+    std::vector<double> frame_ms;
+    std::vector<Vertex> staged_vertices;
+    std::vector<unsigned> staged_indices;
+    size_t uploads = 0;
+    size_t releases = 0;
+    size_t resident_sum = 0;
+    size_t resident_max = 0;
+    size_t cpu_bytes_max = 0;
+    size_t gpu_bytes_max = 0;
+    size_t missing_sum = 0;
+    MeshCache::Stats cache_stats;
+
+    const auto upload = [&](const glm::ivec3 &, const Mesh &mesh) {
+        staged_vertices.assign(mesh.vertices.begin(), mesh.vertices.end());
+        staged_indices.assign(mesh.indices.begin(), mesh.indices.end());
+        uploads += benchmark.timing() ? 1 : 0;
+    };
+
+    const auto release = [&](const glm::ivec3 &) { releases += benchmark.timing() ? 1 : 0; };
+
+    auto &result = benchmark.run(
+        name, {{"scene", "terrain"}, {"chunk_size", "32"}, {"frames", std::to_string(frame_count)}}, [&]() {
+            ChunkWorld world(generate, upload, release, settings);
+
+            for (unsigned frame = 0; frame < frame_count; frame++)
+            {
+                const Timer timer;
+                const auto &stats = world.update(glm::vec3(frame * speed, 40.0f, 0.0f));
+                const auto elapsed = timer.round();
+                if (elapsed < frame_interval)
+                {
+                    std::this_thread::sleep_for(frame_interval - elapsed);
+                }
+
+                // The warmup and memory runs are not sampled.
+                if (benchmark.timing())
+                {
+                    resident_sum += stats.gpu_chunks;
+                    resident_max = std::max(resident_max, stats.gpu_chunks);
+                    cpu_bytes_max = std::max(cpu_bytes_max, stats.cpu_bytes);
+                    gpu_bytes_max = std::max(gpu_bytes_max, stats.gpu_bytes);
+                    missing_sum += stats.missing_chunks;
+                    frame_ms.push_back(timer.round().count() / 1e6);
+                }
+            }
+
+            if (benchmark.timing())
+            {
+                cache_stats = world.get_mesh_cache().get_stats();
+            }
+        });
+
+    // A hitch is a frame that ran half an interval over, the residency counters show the budgets holding.
+    const double total_ms = std::accumulate(frame_ms.begin(), frame_ms.end(), 0.0);
+    const auto hitches = std::count_if(frame_ms.begin(), frame_ms.end(), [&](const double ms) {
+        return ms > 1.5 * std::chrono::duration<double, std::milli>(frame_interval).count();
+    });
+    std::sort(frame_ms.begin(), frame_ms.end());
+    const auto percentile = [&](const double p) { return frame_ms[size_t(p * (frame_ms.size() - 1))]; };
+    result.add_counter("frames", frame_ms.size());
+    result.add_counter("hitches", hitches);
+    result.add_counter("frame_p99_ms", percentile(0.99));
+    result.add_counter("frame_max_ms", frame_ms.back());
+    result.add_counter("resident_chunks_avg", double(resident_sum) / frame_ms.size());
+    result.add_counter("resident_chunks_max", resident_max);
+    result.add_counter("cpu_bytes_max", cpu_bytes_max);
+    result.add_counter("gpu_bytes_max", gpu_bytes_max);
+    result.add_counter("missing_chunks_avg", double(missing_sum) / frame_ms.size());
+    result.add_counter("chunks_per_s", uploads / (total_ms / 1e3));
+    result.add_counter("releases", releases);
+    result.add_counter("mesh_cache_hits", cache_stats.hits);
+    result.add_counter("mesh_cache_saved_bytes", cache_stats.saved_bytes);
+    benchmark.print(result);
+}
+
+void write_synthetic_vox(const std::string &path, unsigned size)
+{
+    // Dense cube with cycling palette indices, stored as a single SIZE and XYZI pair.
+    const uint32_t voxel_count = size * size * size;
+    const uint32_t size_chunk_size = 12 + 12;
+    const uint32_t xyzi_chunk_size = 12 + 4 + voxel_count * 4;
+    const uint32_t version = 150;
+    const uint32_t zero = 0;
+    const uint32_t main_children_size = size_chunk_size + xyzi_chunk_size;
+    const uint32_t size_data_size = 12;
+    const uint32_t xyzi_data_size = 4 + voxel_count * 4;
+
+    std::vector<uint8_t> entries;
+    entries.reserve(voxel_count * 4);
+
+    for (unsigned z = 0; z < size; z++)
+    {
+        for (unsigned y = 0; y < size; y++)
+        {
+            for (unsigned x = 0; x < size; x++)
+            {
+                entries.insert(entries.end(), {(uint8_t)x, (uint8_t)y, (uint8_t)z, (uint8_t)(1 + (x + y + z) % 255)});
+            }
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+
+    const auto write_u32 = [&file](uint32_t value) { file.write(reinterpret_cast<const char *>(&value), 4); };
+
+    file.write("VOX ", 4);
+    write_u32(version);
+    file.write("MAIN", 4);
+    write_u32(zero);
+    write_u32(main_children_size);
+    file.write("SIZE", 4);
+    write_u32(size_data_size);
+    write_u32(zero);
+    write_u32(size);
+    write_u32(size);
+    write_u32(size);
+    file.write("XYZI", 4);
+    write_u32(xyzi_data_size);
+    write_u32(zero);
+    write_u32(voxel_count);
+    file.write(reinterpret_cast<const char *>(entries.data()), entries.size());
+    file.close();
+}
+
+void load_group(Benchmark &benchmark)
+{
+    auto files = SceneLibrary::vox_files();
+
+    for (const unsigned size : {64, 128, 192})
+    {
+        const auto name = "synthetic-" + std::to_string(size);
+        const auto path = (std::filesystem::temp_directory_path() / (name + ".vox")).string();
+
+        if (benchmark.enabled("load/" + name))
+        {
+            write_synthetic_vox(path, size);
+            files.push_back({name, path});
+        }
+    }
+
+    const std::vector<std::pair<std::string, std::function<void(const VoxParser &)>>> targets = {
+        {"parse", [](const VoxParser &) {}},
+        {"array", [](const VoxParser &parser) { parser.get_voxel_grid(); }},
+        {"palette", [](const VoxParser &parser) { parser.get_palette_voxel_grid(); }},
+        {"scene", [](const VoxParser &parser) { parser.get_scene_grid(); }},
+    };
+
+    for (const auto &file : files)
+    {
+        const auto &file_name = file.first;
+        const auto &path = file.second;
+        const auto file_size = std::filesystem::file_size(path);
+
+        for (const auto &target : targets)
+        {
+            const auto &target_name = target.first;
+            const auto &load = target.second;
+            const auto name = fmt::format("load/{}/{}", file_name, target_name);
+            if (!benchmark.enabled(name))
+            {
+                continue;
+            }
+
+            auto &result = benchmark.run(name, {{"file", file_name}, {"target", target_name}}, [&]() {
+                VoxParser parser(path);
+                load(parser);
+            });
+
+            result.add_counter("bytes", file_size);
+            result.add_counter("mb_per_s", (file_size / (1024.0 * 1024.0)) / (result.median_ns / 1e9));
+            benchmark.print(result);
+        }
+
+        // Generated files are written to the temporary directory and not kept around.
+        if (file_name.rfind("synthetic-", 0) == 0)
+        {
+            std::filesystem::remove(path);
+        }
+    }
+}
+
+void startup_group(Benchmark &benchmark)
+{
+    for (const auto &file : SceneLibrary::vox_files())
+    {
+        const auto &file_name = file.first;
+        const auto &path = file.second;
+        const auto cache_path =
+            (std::filesystem::temp_directory_path() / std::filesystem::path(path).filename().replace_extension(".vbz"))
+                .string();
+
+        // Cold start parses, meshes and writes the cache.
+        const auto cold_name = fmt::format("startup/{}/cold", file_name);
+        if (benchmark.enabled(cold_name))
+        {
+            auto &result = benchmark.run(cold_name, {{"file", file_name}, {"start", "cold"}}, [&]() {
+                const auto source_hash = VbzCache::hash_file(path);
+                VoxParser parser(path);
+                const auto voxel_grid = parser.get_voxel_grid();
+                VbzCache::write(cache_path, source_hash, *voxel_grid, {voxel_grid->meshify_greedy()});
+            });
+
+            benchmark.print(result);
+        }
+
+        // Warm start hashes the source, maps the cache and reads the buffers like an upload would.
+        const auto warm_name = fmt::format("startup/{}/warm", file_name);
+        const bool warm_enabled = benchmark.enabled(warm_name) && std::filesystem::exists(cache_path);
+
+        // Without the cold case the cache on disk may be left over from another source or version.
+        if (warm_enabled && !VbzCache::open(cache_path, VbzCache::hash_file(path)))
+        {
+            spdlog::warn("Skipping `{}`, the cache `{}` is stale or invalid.", warm_name, cache_path);
+        }
+        else if (warm_enabled)
+        {
+            size_t vertex_count = 0;
+            auto &result = benchmark.run(warm_name, {{"file", file_name}, {"start", "warm"}}, [&]() {
+                const auto cache = VbzCache::open(cache_path, VbzCache::hash_file(path));
+                const auto mesh_view = cache->get_mesh();
+                const auto checksum = hash_bytes(mesh_view.vertices, mesh_view.vertex_count * sizeof(Vertex)) ^
+                                      hash_bytes(mesh_view.indices, mesh_view.index_count * sizeof(unsigned));
+                spdlog::debug("Read cached buffers with checksum {:x}", checksum);
+                vertex_count = mesh_view.vertex_count;
+            });
+
+            result.add_counter("vertices", vertex_count);
+            benchmark.print(result);
+        }
+
+        std::filesystem::remove(cache_path);
+    }
+}
+
+void export_group(Benchmark &benchmark, const SceneLibrary &library)
+{
+    const std::vector<std::pair<std::string, std::function<void(const Mesh &, const std::string &)>>> exporters = {
+        {"obj", &Mesh::save_obj}, {"ply", &Mesh::save_ply}, {"glb", &Mesh::save_glb}};
+
+    ArrayVoxelGrid noise = ArrayVoxelGrid(128, 128, 128);
+    library.get_scene("noise").fill(noise);
+    const std::vector<std::pair<std::string, Mesh>> meshes = {{"culled", noise.meshify_culled()},
+                                                              {"greedy", noise.meshify_greedy()}};
+
+    for (const auto &[mesh_name, mesh] : meshes)
+    {
+        for (const auto &entry : exporters)
+        {
+            const auto &format = entry.first;
+            const auto &exporter = entry.second;
+            const auto name = fmt::format("export/noise-128-{}/{}", mesh_name, format);
+            if (!benchmark.enabled(name))
+            {
+                continue;
+            }
+
+            const auto path = (std::filesystem::temp_directory_path() / ("export." + format)).string();
+            const auto &exported_mesh = mesh;
+            auto &result = benchmark.run(name, {{"mesh", mesh_name}, {"format", format}},
+                                         [&]() { exporter(exported_mesh, path); });
+
+            const auto file_size = std::filesystem::file_size(path);
+            result.add_counter("bytes", file_size);
+            result.add_counter("mb_per_s", (file_size / (1024.0 * 1024.0)) / (result.median_ns / 1e9));
+            benchmark.print(result);
+            std::filesystem::remove(path);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    spdlog::set_level(spdlog::level::warn);
+
+    try
+    {
+        const auto options = BenchmarkOptions::parse(argc, argv);
+        Benchmark benchmark(options);
+        Profiler::set_enabled(!options.profile.empty());
+        const SceneLibrary library(options.seed);
+
+        if (options.has_group("fill"))
+        {
+            fill_group(benchmark, options, library);
+        }
+
+        if (options.has_group("mesh"))
+        {
+            mesh_group(benchmark, options, library);
+        }
+
+        if (options.has_group("lod"))
+        {
+            lod_group(benchmark, options, library);
+        }
+
+        if (options.has_group("label"))
+        {
+            label_group(benchmark, options, library);
+        }
+
+        if (options.has_group("snapshot"))
+        {
+            snapshot_group(benchmark, options, library);
+        }
+
+        if (options.has_group("optimize"))
+        {
+            optimize_group(benchmark, options, library);
+        }
+
+        if (options.has_group("pipeline"))
+        {
+            pipeline_group(benchmark, options, library);
+        }
+
+        if (options.has_group("cache"))
+        {
+            cache_group(benchmark, options, library);
+        }
+
+        if (options.has_group("world"))
+        {
+            world_group(benchmark);
+        }
+
+        if (options.has_group("load"))
+        {
+            load_group(benchmark);
+        }
+
+        if (options.has_group("startup"))
+        {
+            startup_group(benchmark);
+        }
+
+        if (options.has_group("export"))
+        {
+            export_group(benchmark, library);
+        }
+
+        benchmark.write_json(options.output);
+
+        if (!options.profile.empty())
+        {
+            Profiler::write_chrome_trace(options.profile);
+        }
+    }
+    catch (const std::exception &error)
+    {
+        spdlog::error("{}", error.what());
+        return 1;
+    }
+
+    return 0;
+}
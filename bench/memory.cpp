@@ -0,0 +1,185 @@
+#include "memory.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+namespace
+{
+    std::atomic<size_t> heap_bytes{0};
+    std::atomic<size_t> peak_heap_bytes{0};
+    std::atomic<size_t> allocation_count{0};
+    std::atomic<size_t> allocated_bytes{0};
+
+    // Every block is prefixed with its size, so deletes without a size can be accounted too.
+    constexpr size_t header_size = alignof(std::max_align_t);
+
+    void *counted_allocate(size_t size)
+    {
+        void *block = std::malloc(header_size + size);
+        if (block == nullptr)
+        {
+            return nullptr;
+        }
+
+        *static_cast<size_t *>(block) = size;
+
+        const size_t current = heap_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+
+        size_t peak = peak_heap_bytes.load(std::memory_order_relaxed);
+        while (current > peak && !peak_heap_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+        {
+        }
+
+        return static_cast<char *>(block) + header_size;
+    }
+
+    void counted_free(void *pointer)
+    {
+        if (pointer == nullptr)
+        {
+            return;
+        }
+
+        void *block = static_cast<char *>(pointer) - header_size;
+        heap_bytes.fetch_sub(*static_cast<size_t *>(block), std::memory_order_relaxed);
+        std::free(block);
+    }
+
+    void *throwing_allocate(size_t size)
+    {
+        void *pointer = counted_allocate(size);
+        if (pointer == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        return pointer;
+    }
+
+#ifdef __linux__
+    // Reads a kilobyte value like `VmHWM` from the process status.
+    size_t read_status_bytes(const char *key)
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        const size_t key_size = std::strlen(key);
+
+        while (std::getline(status, line))
+        {
+            if (line.compare(0, key_size, key) == 0 && line.size() > key_size && line[key_size] == ':')
+            {
+                return std::stoull(line.substr(key_size + 1)) * 1024;
+            }
+        }
+
+        return 0;
+    }
+
+    // Resets the peak resident set size to the current one, supported since Linux 4.0.
+    bool reset_peak_rss()
+    {
+        std::ofstream clear_refs("/proc/self/clear_refs");
+        clear_refs << "5";
+        return clear_refs.good();
+    }
+#endif
+}
+
+void *operator new(size_t size)
+{
+    return throwing_allocate(size);
+}
+
+void *operator new[](size_t size)
+{
+    return throwing_allocate(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return counted_allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return counted_allocate(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    counted_free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    counted_free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    counted_free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    counted_free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+    counted_free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+    counted_free(pointer);
+}
+
+size_t current_rss_bytes()
+{
+#ifdef __linux__
+    return read_status_bytes("VmRSS");
+#else
+    return 0;
+#endif
+}
+
+MemoryScope::MemoryScope()
+{
+    // Reading the process status allocates itself, so it happens before the heap counters are taken.
+#ifdef __linux__
+    base_rss_bytes = reset_peak_rss() ? current_rss_bytes() : 0;
+#else
+    base_rss_bytes = 0;
+#endif
+
+    base_heap_bytes = heap_bytes.load(std::memory_order_relaxed);
+    base_allocations = allocation_count.load(std::memory_order_relaxed);
+    base_allocated_bytes = allocated_bytes.load(std::memory_order_relaxed);
+    peak_heap_bytes.store(base_heap_bytes, std::memory_order_relaxed);
+}
+
+MemoryStats MemoryScope::stop()
+{
+    MemoryStats stats;
+    stats.allocations = allocation_count.load(std::memory_order_relaxed) - base_allocations;
+    stats.allocated_bytes = allocated_bytes.load(std::memory_order_relaxed) - base_allocated_bytes;
+    stats.peak_heap_bytes = peak_heap_bytes.load(std::memory_order_relaxed) - base_heap_bytes;
+
+#ifdef __linux__
+    // Without a reset the high water mark covers the whole process and says nothing about this section.
+    if (base_rss_bytes != 0)
+    {
+        const size_t peak_rss = read_status_bytes("VmHWM");
+        stats.peak_rss_growth_bytes = peak_rss > base_rss_bytes ? peak_rss - base_rss_bytes : 0;
+    }
+#endif
+
+    return stats;
+}
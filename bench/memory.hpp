@@ -0,0 +1,29 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+
+// Memory used by a measured section. Heap numbers come from the counting global allocator of the benchmark
+// executable. The resident set growth comes from the operating system and is zero where that is not available.
+struct MemoryStats
+{
+    size_t allocations = 0;
+    size_t allocated_bytes = 0;
+    size_t peak_heap_bytes = 0;
+    size_t peak_rss_growth_bytes = 0;
+};
+
+// Measures the memory from construction until `stop`. Scopes must not be nested.
+class MemoryScope
+{
+  public:
+    MemoryScope();
+    MemoryStats stop();
+
+  private:
+    size_t base_heap_bytes;
+    size_t base_allocations;
+    size_t base_allocated_bytes;
+    size_t base_rss_bytes;
+};
+
+size_t current_rss_bytes();
@@ -0,0 +1,139 @@
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef __linux__
+    int open_counter(const uint64_t config)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = config;
+        attributes.disabled = 1;
+        attributes.inherit = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+    }
+#endif
+}
+
+const char *PerfStats::name(const Counter counter)
+{
+    switch (counter)
+    {
+    case Cycles:
+        return "cycles";
+    case Instructions:
+        return "instructions";
+    case CacheMisses:
+        return "cache_misses";
+    case BranchMisses:
+        return "branch_misses";
+    default:
+        return "unknown";
+    }
+}
+
+PerfStats &PerfStats::operator+=(const PerfStats &other)
+{
+    for (size_t i = 0; i < CounterCount; i++)
+    {
+        values[i] += other.values[i];
+        available[i] = available[i] || other.available[i];
+    }
+
+    return *this;
+}
+
+PerfCounters::PerfCounters()
+{
+    descriptors.fill(-1);
+
+#ifdef __linux__
+    const std::array<uint64_t, PerfStats::CounterCount> configs = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES};
+
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        descriptors[i] = open_counter(configs[i]);
+    }
+#endif
+
+    if (!available())
+    {
+        spdlog::warn("Hardware performance counters are unavailable, only timings are reported");
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for (const int descriptor : descriptors)
+    {
+        if (descriptor >= 0)
+        {
+            close(descriptor);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::available() const
+{
+    return std::any_of(descriptors.begin(), descriptors.end(), [](const int descriptor) { return descriptor >= 0; });
+}
+
+void PerfCounters::start()
+{
+#ifdef __linux__
+    for (const int descriptor : descriptors)
+    {
+        if (descriptor >= 0)
+        {
+            ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+            ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+PerfStats PerfCounters::stop()
+{
+    PerfStats stats;
+
+#ifdef __linux__
+    for (size_t i = 0; i < descriptors.size(); i++)
+    {
+        if (descriptors[i] < 0)
+        {
+            continue;
+        }
+
+        ioctl(descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+
+        // Value, time enabled and time running. Counters multiplexed with others are scaled up.
+        uint64_t data[3] = {};
+        if (read(descriptors[i], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+        {
+            continue;
+        }
+
+        stats.values[i] = static_cast<double>(data[0]) * data[1] / data[2];
+        stats.available[i] = true;
+    }
+#endif
+
+    return stats;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+
+// Hardware counter totals of a measured section. Counters that could not be opened are reported as missing.
+struct PerfStats
+{
+    enum Counter
+    {
+        Cycles,
+        Instructions,
+        CacheMisses,
+        BranchMisses,
+        CounterCount
+    };
+
+    std::array<double, CounterCount> values = {};
+    std::array<bool, CounterCount> available = {};
+
+    static const char *name(const Counter counter);
+    PerfStats &operator+=(const PerfStats &other);
+};
+
+// User space hardware counters of this process and the threads it starts, read through `perf_event_open` on Linux.
+// Opening fails gracefully on other platforms, in containers and with restrictive `perf_event_paranoid` settings.
+class PerfCounters : Wrapper
+{
+  public:
+    PerfCounters();
+    ~PerfCounters();
+    bool available() const;
+    void start();
+    PerfStats stop();
+
+  private:
+    std::array<int, PerfStats::CounterCount> descriptors;
+};
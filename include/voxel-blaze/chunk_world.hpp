@@ -0,0 +1,90 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/mesh_cache.hpp>
+#include <voxel-blaze/mesh_pipeline.hpp>
+#include <voxel-blaze/voxels/palette_voxel_grid.hpp>
+
+// Unbounded world split into cubic chunks. Chunks around the camera are generated and meshed on the mesh pipeline and
+// handed to `upload`, chunks that have not been visible for the longest time are dropped first once the CPU or GPU
+// budget is exceeded. Dropped chunks are generated again when they come back into view.
+class ChunkWorld : Wrapper
+{
+  public:
+    struct Settings
+    {
+        unsigned chunk_size = 32;
+        // Chunks whose center is within this many chunks of the camera are visible.
+        float view_radius = 4.0f;
+        size_t cpu_budget_bytes = size_t(64) << 20;
+        size_t gpu_budget_bytes = size_t(64) << 20;
+        // Finished meshes are uploaded for at most this long per update.
+        std::chrono::microseconds upload_budget = std::chrono::milliseconds(2);
+        // Jobs queued ahead on the pipeline, few enough that requests follow the camera closely.
+        size_t max_pending_jobs = 16;
+        // Meshes kept for chunks with equal contents, which are common in generated worlds.
+        size_t mesh_cache_bytes = size_t(16) << 20;
+        // Reorders chunk meshes for the vertex cache before they are cached and uploaded.
+        bool optimize_meshes = true;
+    };
+
+    struct Stats
+    {
+        size_t visible_chunks = 0;
+        // Visible chunks that are not uploaded yet.
+        size_t missing_chunks = 0;
+        size_t cpu_chunks = 0;
+        size_t cpu_bytes = 0;
+        size_t gpu_chunks = 0;
+        size_t gpu_bytes = 0;
+        // Work done during the last update.
+        size_t requested = 0;
+        size_t uploaded = 0;
+        // Chunks whose generator or mesher threw.
+        size_t failed = 0;
+        size_t cpu_evicted = 0;
+        size_t gpu_evicted = 0;
+    };
+
+    // Fills `grid` with the chunk at `chunk`, its voxel (0, 0, 0) lies at `chunk * chunk_size` in world space.
+    using Generator = std::function<void(const glm::ivec3 &chunk, VoxelGrid &grid)>;
+    // Chunk meshes are centered on the chunk like every grid mesh, see `get_chunk_center`.
+    using Upload = std::function<void(const glm::ivec3 &chunk, const Mesh &mesh)>;
+    using Release = std::function<void(const glm::ivec3 &chunk)>;
+
+    ChunkWorld(Generator generate, Upload upload, Release release);
+    ChunkWorld(Generator generate, Upload upload, Release release, const Settings &settings);
+    // Call once per frame with the camera position in world space.
+    const Stats &update(const glm::vec3 &camera_position);
+    const Stats &get_stats() const;
+    glm::vec3 get_chunk_center(const glm::ivec3 &chunk) const;
+    const MeshCache &get_mesh_cache() const;
+
+  private:
+    struct Chunk
+    {
+        glm::ivec3 position;
+        // Shared with a running job, empty while the chunk is not resident in CPU memory.
+        std::shared_ptr<PaletteVoxelGrid> grid;
+        size_t mesh_bytes = 0;
+        bool uploaded = false;
+        bool pending = false;
+        uint64_t last_visible = 0;
+    };
+
+    static uint64_t calculate_key(const glm::ivec3 &chunk);
+    void request(Chunk &chunk);
+    std::shared_ptr<const Mesh> meshify(const PaletteVoxelGrid &grid);
+    void evict();
+
+    const Generator generate;
+    const Upload upload;
+    const Release release;
+    const Settings settings;
+    std::unordered_map<uint64_t, Chunk> chunks;
+    uint64_t frame = 0;
+    Stats stats;
+    MeshCache mesh_cache;
+    // Declared last so its workers are joined before the chunks they write into are destroyed.
+    MeshPipeline pipeline;
+};
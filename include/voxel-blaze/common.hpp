@@ -4,8 +4,11 @@
 
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cinttypes>
+#include <cstring>
+#include <filesystem>
 #include <fmt/core.h>
 #include <fstream>
 #include <functional>
@@ -17,9 +20,11 @@
 #include <initializer_list>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <spdlog/spdlog.h>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -9,7 +9,9 @@ public:
     ~Camera() = default;
     void look_at(const glm::vec3 &position, const glm::vec3 &target);
     const float *const matrix_ptr() const;
+    glm::vec3 get_position() const;
 
 private:
     glm::mat4 view_matrix;
+    glm::vec3 position = glm::vec3(0.0f);
 };
\ No newline at end of file
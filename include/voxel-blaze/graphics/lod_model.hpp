@@ -0,0 +1,26 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/graphics/mesh.hpp>
+#include <voxel-blaze/graphics/model.hpp>
+
+// Uploaded meshes of every LOD pyramid level. Level `i` is drawn scaled by `2^i`, so all levels cover the same space.
+// Levels can also arrive one by one, missing levels are left empty until they are set.
+class LodModel : Wrapper
+{
+  public:
+    LodModel(const std::vector<Mesh> &meshes);
+    LodModel(const size_t level_count);
+    void set_level(const size_t level, const Mesh &mesh);
+    bool has_level(const size_t level) const;
+    void translate(const glm::vec3 translations);
+    void rotate(const glm::vec3 angles);
+    glm::mat4 get_tranform() const;
+    glm::mat4 get_level_transform(const size_t level) const;
+    size_t level_count() const;
+    const Model &get_level(const size_t level) const;
+
+  private:
+    std::vector<std::unique_ptr<Model>> levels;
+    glm::mat4 transform = glm::mat4(1.0f);
+};
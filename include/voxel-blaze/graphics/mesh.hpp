@@ -3,32 +3,68 @@
 #include <voxel-blaze/common.hpp>
 #include <voxel-blaze/graphics/vertex.hpp>
 
+// Range of a shared vertex and index buffer that belongs to one chunk. Indices address the whole vertex buffer, except
+// in a `ShortIndexMesh`.
+struct MeshChunk
+{
+    uint32_t vertex_offset, vertex_count;
+    uint32_t index_offset, index_count;
+};
+
+// Non-owning view of mesh data, for example stored in a mapped file.
+struct MeshView
+{
+    // Vertices that 16-bit indices can address.
+    static constexpr size_t max_short_vertex_count = size_t(1) << 16;
+
+    const Vertex *vertices = nullptr;
+    size_t vertex_count = 0;
+    const unsigned *indices = nullptr;
+    size_t index_count = 0;
+
+    // Size of the buffers once uploaded, exact up to `max_short_vertex_count` vertices and a lower bound above.
+    inline size_t gpu_bytes() const
+    {
+        return vertex_count * sizeof(Vertex) + index_count * sizeof(uint16_t);
+    }
+};
+
+// Mesh with 16-bit indices, split into chunks of at most `max_vertex_count` vertices whose indices count from the first
+// vertex of their chunk. Chunks are drawn with their vertex offset as base vertex.
+struct ShortIndexMesh
+{
+    std::vector<uint16_t> indices;
+    std::vector<Vertex> vertices;
+    std::vector<MeshChunk> chunks;
+
+    // Triangles keep their order, vertices used on both sides of a chunk border are duplicated.
+    static ShortIndexMesh build(const MeshView &mesh, const size_t max_vertex_count = MeshView::max_short_vertex_count);
+};
+
+// Post-transform vertex cache efficiency of an index buffer, simulated with a FIFO cache.
+struct VertexCacheStats
+{
+    // Vertex shader invocations per triangle and per referenced vertex, at best about 0.5 and exactly 1.
+    double acmr = 0;
+    double atvr = 0;
+};
+
 struct Mesh
 {
     std::vector<unsigned> indices;
     std::vector<Vertex> vertices;
 
-    inline void save_obj(const std::string &path) const
+    inline MeshView view() const
     {
-        std::ofstream file(path);
-        if (!file.is_open())
-        {
-            throw std::runtime_error("Unable to open file");
-        }
-
-        for (const auto &vertex : vertices)
-        {
-            file << "v " << vertex.x << " " << vertex.y << " " << vertex.z << "\n";
-        }
-
-        for (size_t i = 0; i < indices.size(); i += 3)
-        {
-            if (i + 2 < indices.size())
-            {
-                file << "f " << indices[i] + 1 << " " << indices[i + 1] + 1 << " " << indices[i + 2] + 1 << "\n";
-            }
-        }
-
-        file.close();
+        return MeshView{vertices.data(), vertices.size(), indices.data(), indices.size()};
     }
+
+    // Reorders triangles for the post-transform vertex cache with Tipsify, then vertices by first use so they are
+    // fetched in order. Runs in linear time, unreferenced vertices are dropped.
+    void optimize(const unsigned cache_size = 16);
+    VertexCacheStats analyze_vertex_cache(const unsigned cache_size = 16) const;
+
+    void save_obj(const std::string &path) const;
+    void save_ply(const std::string &path) const;
+    void save_glb(const std::string &path) const;
 };
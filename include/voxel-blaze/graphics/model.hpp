@@ -7,16 +7,27 @@ class Model : Wrapper
 {
   public:
     Model(const Mesh &mesh);
+    Model(const MeshView &mesh);
     ~Model();
     void translate(const glm::vec3 translations);
     void rotate(const glm::vec3 angles);
     glm::mat4 get_tranform() const;
+    // Size of the vertex and index buffers on the GPU.
+    size_t get_gpu_bytes() const;
 
   private:
     friend class Renderer;
+    void upload(const Vertex *vertices, const size_t vertex_count, const void *indices, const size_t index_count);
+
     unsigned index_buffer;
     unsigned vertex_count;
     unsigned vertex_buffer;
+    // 16-bit indices unless the mesh needs more vertices than they address and splitting it would cost more than it
+    // saves. Split meshes are drawn chunk by chunk.
+    unsigned index_type = GL_UNSIGNED_SHORT;
+    size_t index_size = sizeof(uint16_t);
+    std::vector<MeshChunk> chunks;
+    size_t gpu_bytes = 0;
     unsigned vertex_array;
     glm::mat4 transform = glm::mat4(1.0f);
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <voxel-blaze/graphics/shader.hpp>
+#include <voxel-blaze/graphics/lod_model.hpp>
 #include <voxel-blaze/graphics/model.hpp>
 #include <voxel-blaze/graphics/camera.hpp>
 #include <voxel-blaze/common.hpp>
@@ -12,8 +13,17 @@ public:
     ~Renderer() = default;
 
     float draw(const Camera &camera, const Model &model);
+    float draw(const Camera &camera, const LodModel &model);
+    size_t select_level(const Camera &camera, const LodModel &model) const;
 
 private:
+    static constexpr float field_of_view = 45.0f;
+    static constexpr float viewport_height = 1280.0f;
+    // Coarser levels are used while one of their voxels covers at most this many pixels.
+    static constexpr float lod_pixel_threshold = 1.0f;
+
+    float draw(const Camera &camera, const Model &model, const glm::mat4 &transform);
+
     const Shader shader;
     std::chrono::system_clock::time_point last_time;
 };
\ No newline at end of file
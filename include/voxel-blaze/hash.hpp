@@ -0,0 +1,37 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+
+inline uint64_t hash_mix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+// Fast non-cryptographic hash over a byte range, consumes eight bytes per step.
+inline uint64_t hash_bytes(const void *data, const size_t size, const uint64_t seed = 0x9e3779b97f4a7c15ull)
+{
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint64_t hash = seed ^ (size * 0x9e3779b97f4a7c15ull);
+    size_t offset = 0;
+
+    for (; offset + 8 <= size; offset += 8)
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes + offset, sizeof(word));
+        hash ^= word;
+        hash = ((hash << 29) | (hash >> 35)) * 0x9e3779b97f4a7c15ull;
+    }
+
+    uint64_t tail = 0;
+    if (offset < size)
+    {
+        std::memcpy(&tail, bytes + offset, size - offset);
+    }
+
+    return hash_mix(hash ^ tail);
+}
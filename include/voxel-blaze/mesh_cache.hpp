@@ -0,0 +1,52 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/graphics/mesh.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+
+// Shares one mesh between grids with equal contents, such as the many fully solid, empty or repeated chunks of a world.
+// Entries are keyed by a content hash and the least recently used ones are dropped once the budget is exceeded. Safe to
+// use from several threads.
+class MeshCache : Wrapper
+{
+  public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        // Mesh memory and meshing time that hits did not spend.
+        size_t saved_bytes = 0;
+        std::chrono::nanoseconds saved_time{0};
+    };
+
+    MeshCache(const size_t budget_bytes = size_t(64) << 20);
+
+    // `variant` is mixed into the key and tells apart everything else the mesh depends on, such as the mesher or the
+    // borders of neighbouring chunks.
+    static uint64_t calculate_key(const VoxelGrid &grid, const uint64_t variant = 0);
+    static size_t calculate_bytes(const Mesh &mesh);
+    // Returns the cached mesh of `key`, or runs `meshify` and caches its result. `meshify` runs outside the lock, so
+    // concurrent misses of one key may both mesh.
+    std::shared_ptr<const Mesh> get(const uint64_t key, const std::function<Mesh()> &meshify);
+    Stats get_stats() const;
+
+  private:
+    struct Entry
+    {
+        uint64_t key;
+        std::shared_ptr<const Mesh> mesh;
+        size_t bytes;
+        std::chrono::nanoseconds time;
+    };
+
+    const size_t budget_bytes;
+    mutable std::mutex mutex;
+    // Most recently used first.
+    std::list<Entry> entries;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> lookup;
+    Stats stats;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/graphics/mesh.hpp>
+
+// Runs mesh jobs on worker threads and hands the results back to the render thread in small portions per frame. Every
+// job belongs to a key, a newer request for a key replaces a queued one and drops the result of a running one. Meshes
+// are passed around shared, so jobs can hand out cached meshes without copying them.
+class MeshPipeline : Wrapper
+{
+  public:
+    MeshPipeline(const unsigned worker_count = default_worker_count());
+    ~MeshPipeline();
+
+    // `job` runs on a worker thread, so it must only read data that stays unchanged until it finished. Grids that keep
+    // being edited should be meshed through a snapshot. Exceptions thrown by `job` are logged and reported on drain.
+    void request(const uint64_t key, std::function<std::shared_ptr<const Mesh>()> job);
+    // Passes finished meshes to `consume` until `budget` is used up, at least one when any is ready. Keys whose job
+    // threw are passed to `fail` instead. Call it once per frame on the thread that uploads the meshes.
+    size_t drain(const std::chrono::microseconds budget,
+                 const std::function<void(uint64_t key, const std::shared_ptr<const Mesh> &mesh)> &consume,
+                 const std::function<void(uint64_t key)> &fail = {});
+    // Jobs that are queued, running or finished but not drained yet.
+    size_t pending_count() const;
+
+    static unsigned default_worker_count();
+
+  private:
+    struct Job
+    {
+        uint64_t key;
+        uint64_t version;
+        std::function<std::shared_ptr<const Mesh>()> run;
+    };
+
+    struct Result
+    {
+        uint64_t key;
+        uint64_t version;
+        std::shared_ptr<const Mesh> mesh;
+        bool failed = false;
+    };
+
+    void work();
+    bool is_latest(const uint64_t key, const uint64_t version) const;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    std::deque<Result> results;
+    // Version of the newest request per key, until its result is drained.
+    std::unordered_map<uint64_t, uint64_t> latest_versions;
+    uint64_t next_version = 0;
+    size_t running_count = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
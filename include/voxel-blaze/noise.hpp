@@ -0,0 +1,8 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+
+// Writes `glm::perlin(glm::vec3(x, y, z) * scale + offset)` for every x in [0, count) to `values`. Eight positions are
+// evaluated at a time with AVX2 when the processor supports it, the remainder falls back to `glm::perlin`.
+void perlin_row(const glm::vec3 &scale, const glm::vec3 &offset, const unsigned y, const unsigned z,
+                const unsigned count, float *values);
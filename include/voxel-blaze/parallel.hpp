@@ -0,0 +1,31 @@
+#pragma once
+
+#include <thread>
+#include <voxel-blaze/common.hpp>
+
+// Splits the range [0, count) into contiguous blocks and runs `function(begin, end)` for each on its own thread.
+template <typename Function>
+inline void parallel_for(const size_t count, Function function)
+{
+    const size_t thread_count = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+
+    if (thread_count <= 1)
+    {
+        function(size_t(0), count);
+        return;
+    }
+
+    const size_t block_size = (count + thread_count - 1) / thread_count;
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count);
+
+    for (size_t begin = 0; begin < count; begin += block_size)
+    {
+        threads.emplace_back(function, begin, std::min(begin + block_size, count));
+    }
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
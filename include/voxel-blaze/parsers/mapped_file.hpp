@@ -0,0 +1,21 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+
+class MappedFile : Wrapper
+{
+  public:
+    MappedFile(const std::string &path);
+    MappedFile(MappedFile &&other);
+    ~MappedFile();
+    const uint8_t *data() const;
+    size_t size() const;
+
+  private:
+    const uint8_t *bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+};
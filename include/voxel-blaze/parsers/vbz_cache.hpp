@@ -0,0 +1,50 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/graphics/mesh.hpp>
+#include <voxel-blaze/parsers/mapped_file.hpp>
+#include <voxel-blaze/voxels/palette_voxel_grid.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+
+// Startup cache holding a palette indexed grid and its generated mesh, laid out to be used straight from a mapping.
+class VbzCache
+{
+  public:
+    static constexpr uint32_t version = 1;
+
+    VbzCache(const std::string &path);
+    ~VbzCache() = default;
+    static void write(const std::string &path, const uint64_t source_hash, const VoxelGrid &voxel_grid,
+                      const std::vector<Mesh> &chunk_meshes);
+    static std::unique_ptr<VbzCache> open(const std::string &path, const uint64_t source_hash);
+    static uint64_t hash_file(const std::string &path);
+    uint64_t get_source_hash() const;
+    glm::uvec3 get_size() const;
+    const Palette &get_palette() const;
+    std::unique_ptr<PaletteVoxelGrid> get_voxel_grid() const;
+    MeshView get_mesh() const;
+    std::vector<MeshChunk> get_chunks() const;
+
+  private:
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t source_hash;
+        uint32_t size_x, size_y, size_z;
+        uint32_t chunk_count;
+        uint64_t vertex_count;
+        uint64_t index_count;
+        uint64_t palette_offset;
+        uint64_t grid_offset;
+        uint64_t chunks_offset;
+        uint64_t vertices_offset;
+        uint64_t indices_offset;
+    };
+
+    template <typename T>
+    const T *section(const uint64_t offset, const uint64_t count) const;
+
+    MappedFile file;
+    Header header;
+};
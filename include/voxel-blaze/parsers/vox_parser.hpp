@@ -1,7 +1,10 @@
 #pragma once
 
 #include <voxel-blaze/common.hpp>
+#include <voxel-blaze/parsers/mapped_file.hpp>
 #include <voxel-blaze/voxels/array_voxel_grid.hpp>
+#include <voxel-blaze/voxels/palette_voxel_grid.hpp>
+#include <voxel-blaze/voxels/sparse_voxel_grid.hpp>
 #include <voxel-blaze/voxels/voxel_grid.hpp>
 
 class VoxParser
@@ -10,23 +13,68 @@ class VoxParser
     VoxParser(const std::string &path);
     ~VoxParser() = default;
     std::unique_ptr<VoxelGrid> get_voxel_grid() const;
+    std::unique_ptr<PaletteVoxelGrid> get_palette_voxel_grid(const size_t model = 0) const;
+    std::unique_ptr<SparseVoxelGrid> get_scene_grid() const;
+    void read_into(VoxelGrid &voxel_grid, const size_t model = 0) const;
+    size_t model_count() const;
+    glm::uvec3 get_size(const size_t model = 0) const;
+    Palette get_palette() const;
 
   private:
-    struct EntryXYZI
+    struct EntryRGBA
     {
-        uint8_t x, y, z, i;
+        uint8_t r, g, b, a;
     };
 
-    struct EntryRGBA
+    struct VoxModel
     {
-        uint8_t r, g, b, a;
+        glm::uvec3 size = glm::uvec3(0);
+        const IndexedVoxel *voxels = nullptr;
+        uint32_t voxel_count = 0;
     };
 
-    std::streamsize read_chunk(std::ifstream &file);
+    struct SceneNode
+    {
+        enum class Type
+        {
+            Transform,
+            Group,
+            Shape
+        };
+
+        Type type;
+        bool hidden = false;
+        glm::ivec3 translation = glm::ivec3(0);
+        uint8_t rotation = 0x04;
+        std::vector<uint32_t> children;
+    };
+
+    // Model placed in the world by its accumulated scene graph transform. Rotations are signed axis permutations.
+    struct ModelInstance
+    {
+        uint32_t model;
+        std::array<glm::ivec3, 3> rotation;
+        glm::ivec3 translation;
+
+        glm::ivec3 apply(const glm::ivec3 &position) const;
+    };
+
+    using Dictionary = std::unordered_map<std::string, std::string>;
+
+    size_t read_chunk(size_t offset, size_t end);
+    void read_node(const char *chunk_id, size_t offset, size_t end);
+    uint32_t read_uint32(size_t offset) const;
+    uint32_t read_uint32(size_t &offset, size_t end) const;
+    std::string read_string(size_t &offset, size_t end) const;
+    Dictionary read_dictionary(size_t &offset, size_t end) const;
+    std::vector<ModelInstance> collect_instances() const;
+    void collect_instances(const uint32_t node_id, const ModelInstance &parent, const unsigned depth,
+                           std::vector<ModelInstance> &instances) const;
 
-    uint32_t size_x;
-    uint32_t size_y;
-    uint32_t size_z;
-    std::vector<EntryXYZI> voxels;
-    std::vector<EntryRGBA> colors;
+    // Keeps the file mapped, model entries point directly into it.
+    MappedFile file;
+    std::vector<VoxModel> models;
+    std::unordered_map<uint32_t, SceneNode> nodes;
+    std::array<EntryRGBA, 256> colors;
+    bool has_colors = false;
 };
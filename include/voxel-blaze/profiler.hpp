@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <voxel-blaze/common.hpp>
+
+struct ProfileEvent
+{
+    const char *name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+};
+
+// Ring buffer of finished zones, written only by the thread owning it. Once full, the oldest events are overwritten.
+// Threads that do not overlap in time may own the same buffer one after another.
+class ProfileBuffer : Wrapper
+{
+  public:
+    static constexpr size_t capacity = 1 << 16;
+
+    const uint32_t thread_id;
+
+    ProfileBuffer(const uint32_t thread_id);
+
+    inline void push(const ProfileEvent &event)
+    {
+        const auto index = write_index.load(std::memory_order_relaxed);
+        events[index & (capacity - 1)] = event;
+        write_index.store(index + 1, std::memory_order_release);
+    }
+
+    std::vector<ProfileEvent> collect() const;
+    void clear();
+
+  private:
+    std::unique_ptr<ProfileEvent[]> events;
+    std::atomic<uint64_t> write_index{0};
+};
+
+// Collects zones of all threads while enabled. Recording takes no locks, threads only register their buffer once.
+// Exports are meant to happen while no zones are recorded, events written concurrently may be torn.
+class Profiler
+{
+  public:
+    static void set_enabled(const bool enabled);
+    static void clear();
+    static void write_chrome_trace(const std::string &path);
+    static ProfileBuffer &thread_buffer();
+
+    static inline bool is_enabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    static inline uint64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+  private:
+    static std::atomic<bool> enabled;
+};
+
+// Records the lifetime of the scope as a zone of the calling thread when the profiler is enabled.
+class ProfileZone : Wrapper
+{
+  public:
+    inline ProfileZone(const char *name) : name(name), recording(Profiler::is_enabled())
+    {
+        if (recording)
+        {
+            start_ns = Profiler::now_ns();
+        }
+    }
+
+    inline ~ProfileZone()
+    {
+        if (recording)
+        {
+            Profiler::thread_buffer().push(ProfileEvent{name, start_ns, Profiler::now_ns()});
+        }
+    }
+
+  private:
+    const char *name;
+    const bool recording;
+    uint64_t start_ns = 0;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Zones are compiled in unless the `profiling` build option is disabled.
+#ifdef VOXEL_BLAZE_PROFILING
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) (void)0
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+
+// Named input for benchmarks and the demo. Generated scenes fill a grid of any size and only depend on the seed, file
+// scenes read a bundled VOX model and keep its size.
+struct Scene
+{
+    std::string name;
+    std::string path;
+    std::function<void(VoxelGrid &)> fill;
+
+    inline bool is_file() const
+    {
+        return !path.empty();
+    }
+
+    glm::uvec3 get_size(const unsigned size) const;
+};
+
+class SceneLibrary
+{
+  public:
+    static constexpr uint64_t default_seed = 1;
+
+    SceneLibrary(const uint64_t seed = default_seed);
+    const std::vector<Scene> &get_scenes() const;
+    const Scene &get_scene(const std::string &name) const;
+
+    static const std::vector<std::pair<std::string, std::string>> &vox_files();
+
+  private:
+    std::vector<Scene> scenes;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/profiler.hpp>
+
+// Statements below `SPDLOG_ACTIVE_LEVEL`, set by the `log_level` build option, are removed at compile time. Hot paths
+// log through `SPDLOG_TRACE` and `SPDLOG_DEBUG` instead of the functions, so release builds carry no logging in them.
+
+// Logs the duration of a coarse phase at debug level when the scope is left and records it as a profiling zone.
+class TraceZone : Wrapper
+{
+  public:
+    inline TraceZone(const char *name)
+        : name(name), enabled(SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG &&
+                              spdlog::default_logger_raw()->should_log(spdlog::level::debug))
+#ifdef VOXEL_BLAZE_PROFILING
+          ,
+          profile_zone(name)
+#endif
+    {
+        if (enabled)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    inline ~TraceZone()
+    {
+        if (enabled)
+        {
+            const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+            spdlog::debug("{} took {:.3f}ms", name, duration.count());
+        }
+    }
+
+  private:
+    const char *name;
+    const bool enabled;
+    std::chrono::steady_clock::time_point start;
+#ifdef VOXEL_BLAZE_PROFILING
+    ProfileZone profile_zone;
+#endif
+};
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG || defined(VOXEL_BLAZE_PROFILING)
+#define TRACE_ZONE(name) TraceZone PROFILE_CONCAT(trace_zone_, __LINE__)(name)
+#else
+#define TRACE_ZONE(name) (void)0
+#endif
@@ -6,12 +6,34 @@
 class ArrayVoxelGrid : public VoxelGrid
 {
 public:
-	ArrayVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z);
+	enum class Layout
+	{
+		// x-major rows, `x + size_x * (y + size_y * z)`.
+		Linear,
+		// 4x4x4 micro-blocks in x-major block order, voxels of a block in Morton order. Neighbours along every axis
+		// mostly share a block, so slices along y and z touch as few cache lines as slices along x.
+		Tiled
+	};
+
+	static constexpr unsigned tile_size = 4;
+
+	ArrayVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z,
+	               const Layout layout = Layout::Linear);
 	virtual ~ArrayVoxelGrid() = default;
 	virtual std::optional<Voxel> get_voxel(const unsigned x, const unsigned y, const unsigned z) const;
 	virtual void set_voxel(const unsigned x, const unsigned y, const unsigned z, const std::optional<Voxel>& voxel);
+	virtual void set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette);
+	virtual void set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors);
+	virtual void fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y, const unsigned z,
+	                           const std::optional<Voxel> &voxel);
+	virtual void get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const;
+	virtual glm::uvec3 get_tile_size() const;
+	Layout get_layout() const;
 
 private:
-	unsigned calculate_index(const unsigned x, const unsigned y, const unsigned z) const;
+	size_t calculate_index(const unsigned x, const unsigned y, const unsigned z) const;
+	const Layout layout;
+	const unsigned blocks_x;
+	const unsigned blocks_y;
 	std::vector<std::optional<Voxel>> voxels;
 };
\ No newline at end of file
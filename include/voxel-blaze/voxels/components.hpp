@@ -0,0 +1,49 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/voxels/array_voxel_grid.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+
+enum class Connectivity
+{
+    // Voxels sharing a face, 6 neighbours.
+    Face,
+    // Voxels sharing a face, an edge or a corner, 26 neighbours.
+    Full
+};
+
+// Bounding box [begin, end) and size of one connected set of occupied voxels.
+struct Component
+{
+    glm::uvec3 begin = glm::uvec3(std::numeric_limits<unsigned>::max());
+    glm::uvec3 end = glm::uvec3(0);
+    size_t voxel_count = 0;
+};
+
+// Splits the occupied voxels of a grid into connected components. Rows are reduced to runs of occupied voxels in
+// parallel, runs of neighbouring rows are merged with a union find, first within blocks of slices on separate threads
+// and then across the block borders. Labels are numbered in x, y, z scan order of their first voxel.
+class ComponentLabeling : Wrapper
+{
+  public:
+    ComponentLabeling(const VoxelGrid &grid, const Connectivity connectivity = Connectivity::Face);
+    const std::vector<Component> &get_components() const;
+    size_t run_count() const;
+    std::optional<unsigned> get_label(const unsigned x, const unsigned y, const unsigned z) const;
+    // Copies the voxels of one component into a grid covering its bounding box, to be meshed and placed at `begin`.
+    std::unique_ptr<ArrayVoxelGrid> extract(const VoxelGrid &grid, const unsigned label) const;
+
+  private:
+    struct Run
+    {
+        unsigned begin;
+        unsigned end;
+        unsigned label;
+    };
+
+    const glm::uvec3 size;
+    // Runs of row `z * size.y + y` are stored in [row_offsets[row], row_offsets[row + 1]), sorted along x.
+    std::vector<size_t> row_offsets;
+    std::vector<Run> runs;
+    std::vector<Component> components;
+};
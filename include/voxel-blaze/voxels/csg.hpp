@@ -0,0 +1,34 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+
+enum class CsgOperation
+{
+    // Writes every source voxel into the target.
+    Union,
+    // Clears target voxels that are not covered by a source voxel.
+    Intersection,
+    // Clears target voxels that are covered by a source voxel.
+    Subtraction,
+    // Writes source voxels only where the target is already occupied.
+    MaskedCopy
+};
+
+// Bounding box [begin, end) of the voxels an operation wrote or cleared, the part of the target to remesh.
+struct DirtyRegion
+{
+    glm::uvec3 begin = glm::uvec3(std::numeric_limits<unsigned>::max());
+    glm::uvec3 end = glm::uvec3(0);
+    unsigned voxel_count = 0;
+
+    inline bool empty() const
+    {
+        return voxel_count == 0;
+    }
+};
+
+// Combines `source`, placed at `offset` in the target's coordinates, into `target`. Occupancy is compared 64 voxels at
+// a time on row bitmasks in parallel, changes are then written as row spans.
+DirtyRegion apply_csg(VoxelGrid &target, const VoxelGrid &source, const glm::ivec3 &offset,
+                      const CsgOperation operation);
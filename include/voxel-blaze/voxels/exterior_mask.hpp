@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+
+// Marks the air of a grid that is reachable from outside through face adjacent air. Everything outside the grid counts
+// as exterior air, so out of range coordinates may be passed directly.
+class ExteriorMask : Wrapper
+{
+  public:
+    ExteriorMask(const VoxelGrid &grid);
+    size_t exterior_count() const;
+
+    inline bool is_exterior(const unsigned x, const unsigned y, const unsigned z) const
+    {
+        if (x >= size.x || y >= size.y || z >= size.z)
+        {
+            return true;
+        }
+
+        const auto word = rows[(size_t(z) * size.y + y) * word_count + x / 64].load(std::memory_order_relaxed);
+        return (word >> (x % 64)) & 1;
+    }
+
+  private:
+    bool update_row(const unsigned y, const unsigned z, uint64_t *seeds);
+
+    const glm::uvec3 size;
+    const size_t word_count;
+    std::vector<uint64_t> air;
+    // Written by the thread owning the row while neighbouring threads read it. Bits are only ever set, so stale reads
+    // just delay propagation to the next sweep.
+    std::vector<std::atomic<uint64_t>> rows;
+};
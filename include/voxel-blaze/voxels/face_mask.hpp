@@ -0,0 +1,52 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+
+// Visible side of a voxel, Front when the voxel lies after the slice and Back when it lies before it.
+struct Face
+{
+    enum class Direction
+    {
+        Front,
+        Back
+    };
+
+    float r, g, b;
+    Direction direction;
+
+    inline bool operator==(const Face &other) const
+    {
+        return std::tie(r, g, b, direction) == std::tie(other.r, other.g, other.b, other.direction);
+    }
+};
+
+// Faces of one slice of a grid, merged into quads by the greedy mesher.
+class Mask2D
+{
+  private:
+    std::vector<std::optional<Face>> data;
+
+  public:
+    const unsigned size_u;
+    const unsigned size_v;
+
+    inline Mask2D(unsigned size_u, unsigned size_v)
+        : data(size_u * size_v, std::nullopt), size_u(size_u), size_v(size_v)
+    {
+    }
+
+    inline void enable(const unsigned u, const unsigned v, const Face face)
+    {
+        data[u * size_v + v] = face;
+    }
+
+    inline void disable(const unsigned u, const unsigned v)
+    {
+        data[u * size_v + v] = std::nullopt;
+    }
+
+    inline std::optional<Face> get(const unsigned u, const unsigned v)
+    {
+        return data[u * size_v + v];
+    }
+};
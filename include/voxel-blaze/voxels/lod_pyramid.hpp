@@ -0,0 +1,28 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/graphics/mesh.hpp>
+#include <voxel-blaze/voxels/array_voxel_grid.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+
+// Mip chain of a grid, every level halves the resolution of the previous one. Level zero is the source grid itself.
+class LodPyramid : Wrapper
+{
+  public:
+    enum class ColorMode
+    {
+        Average,
+        Mode
+    };
+
+    LodPyramid(const VoxelGrid &grid, const unsigned max_levels = 8, const ColorMode color_mode = ColorMode::Mode);
+    size_t level_count() const;
+    const VoxelGrid &get_level(const size_t level) const;
+    std::vector<Mesh> meshify(const std::function<Mesh(const VoxelGrid &)> &mesher) const;
+
+    static std::unique_ptr<ArrayVoxelGrid> downsample(const VoxelGrid &grid, const ColorMode color_mode);
+
+  private:
+    const VoxelGrid &source;
+    std::vector<std::unique_ptr<ArrayVoxelGrid>> levels;
+};
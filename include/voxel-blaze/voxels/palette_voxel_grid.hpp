@@ -0,0 +1,30 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+#include <voxel-blaze/voxels/voxel_palette.hpp>
+
+class PaletteVoxelGrid : public VoxelGrid
+{
+  public:
+    PaletteVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z);
+    virtual ~PaletteVoxelGrid() = default;
+    virtual std::optional<Voxel> get_voxel(const unsigned x, const unsigned y, const unsigned z) const;
+    virtual void set_voxel(const unsigned x, const unsigned y, const unsigned z, const std::optional<Voxel> &voxel);
+    virtual void set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette);
+    virtual void set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors);
+    virtual void fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y, const unsigned z,
+                               const std::optional<Voxel> &voxel);
+    virtual void get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const;
+    // Hashes the indices and the palette, so equal voxels stored under a different palette order hash differently.
+    virtual uint64_t hash_contents() const;
+    uint8_t get_index(const unsigned x, const unsigned y, const unsigned z) const;
+    void set_index(const unsigned x, const unsigned y, const unsigned z, const uint8_t index);
+    void set_indices(const uint8_t *indices, const Palette &palette);
+    const Palette &get_palette() const;
+
+  private:
+    size_t calculate_index(const unsigned x, const unsigned y, const unsigned z) const;
+    std::vector<uint8_t> indices;
+    VoxelPalette palette;
+};
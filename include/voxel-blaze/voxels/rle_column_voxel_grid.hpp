@@ -0,0 +1,54 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+#include <voxel-blaze/voxels/voxel_palette.hpp>
+
+// Stores every (x, y) column as sorted runs of equal voxels along z. Air is not stored, runs that touch always differ
+// in color. Meshers walk the runs directly, so fully covered runs cost nothing per voxel.
+class RleColumnVoxelGrid : public VoxelGrid
+{
+  public:
+    struct Run
+    {
+        unsigned start;
+        unsigned length;
+        uint8_t index;
+
+        inline unsigned end() const
+        {
+            return start + length;
+        }
+    };
+
+    using Column = std::vector<Run>;
+
+    RleColumnVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z);
+    virtual ~RleColumnVoxelGrid() = default;
+    virtual std::optional<Voxel> get_voxel(const unsigned x, const unsigned y, const unsigned z) const;
+    virtual void set_voxel(const unsigned x, const unsigned y, const unsigned z, const std::optional<Voxel> &voxel);
+    virtual void set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette);
+    virtual void set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors);
+    virtual void fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y, const unsigned z,
+                               const std::optional<Voxel> &voxel);
+    virtual void get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const;
+    virtual glm::uvec3 get_tile_size() const;
+    uint8_t get_index(const unsigned x, const unsigned y, const unsigned z) const;
+    const Column &get_column(const unsigned x, const unsigned y) const;
+    const Palette &get_palette() const;
+    size_t run_count() const;
+    size_t storage_bytes() const;
+
+  protected:
+    virtual Mesh meshify_culled_faces(const ExteriorMask *exterior) const;
+    virtual Mesh meshify_greedy_faces(const ExteriorMask *exterior) const;
+
+  private:
+    const Column *find_column(const unsigned x, const unsigned y) const;
+    void write_span(Column &column, const unsigned begin, const unsigned end, const uint8_t index);
+    void decode(const Column &column, uint8_t *indices) const;
+    void encode(const uint8_t *indices, Column &column) const;
+
+    std::vector<Column> columns;
+    VoxelPalette palette;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/voxels/voxel_grid.hpp>
+#include <voxel-blaze/voxels/voxel_palette.hpp>
+
+// Chunks are reference counted and shared between a grid and its snapshots, the first write to a shared chunk copies
+// it. A snapshot is taken on the thread that writes the grid and can then be read on another one while the writes go
+// on.
+class SparseVoxelGrid : public VoxelGrid
+{
+  public:
+    static constexpr unsigned chunk_size = 32;
+
+    SparseVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z);
+    virtual ~SparseVoxelGrid() = default;
+    virtual std::optional<Voxel> get_voxel(const unsigned x, const unsigned y, const unsigned z) const;
+    virtual void set_voxel(const unsigned x, const unsigned y, const unsigned z, const std::optional<Voxel> &voxel);
+    virtual void set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette);
+    virtual void set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors);
+    virtual void fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y, const unsigned z,
+                               const std::optional<Voxel> &voxel);
+    virtual void get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const;
+    virtual glm::uvec3 get_tile_size() const;
+    uint8_t get_index(const unsigned x, const unsigned y, const unsigned z) const;
+    void set_index(const unsigned x, const unsigned y, const unsigned z, const uint8_t index);
+    const Palette &get_palette() const;
+    // Colors for `set_index`, a slot only counts as used once an index refers to it.
+    void set_palette(const Palette &palette);
+    size_t chunk_count() const;
+    size_t shared_chunk_count() const;
+    std::unique_ptr<SparseVoxelGrid> snapshot() const;
+
+  private:
+    using Chunk = std::array<uint8_t, chunk_size * chunk_size * chunk_size>;
+
+    uint64_t calculate_key(const unsigned x, const unsigned y, const unsigned z) const;
+    unsigned calculate_index(const unsigned x, const unsigned y, const unsigned z) const;
+    Chunk &touch_chunk(const unsigned x, const unsigned y, const unsigned z);
+
+    std::unordered_map<uint64_t, std::shared_ptr<Chunk>> chunks;
+    VoxelPalette palette;
+};
@@ -5,4 +5,18 @@
 struct Voxel
 {
     float r, g, b;
-};
\ No newline at end of file
+
+    inline bool operator==(const Voxel &other) const
+    {
+        return r == other.r && g == other.g && b == other.b;
+    }
+};
+
+// Packed voxel position with a palette index, laid out like a VOX XYZI entry.
+struct IndexedVoxel
+{
+    uint8_t x, y, z, i;
+};
+
+// Palette index zero is reserved for empty voxels.
+using Palette = std::array<Voxel, 256>;
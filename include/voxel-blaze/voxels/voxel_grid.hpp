@@ -2,8 +2,11 @@
 
 #include <voxel-blaze/common.hpp>
 #include <voxel-blaze/graphics/mesh.hpp>
+#include <voxel-blaze/voxels/face_mask.hpp>
 #include <voxel-blaze/voxels/voxel.hpp>
 
+class ExteriorMask;
+
 class VoxelGrid
 {
   public:
@@ -11,15 +14,44 @@ class VoxelGrid
     virtual ~VoxelGrid() = default;
     virtual std::optional<Voxel> get_voxel(const unsigned x, const unsigned y, const unsigned z) const = 0;
     virtual void set_voxel(const unsigned x, const unsigned y, const unsigned z, const std::optional<Voxel> &voxel) = 0;
+    virtual void set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette);
+    // Non-zero index `i` refers to `colors[i - 1]`, so palette backends accept at most 255 colors.
+    virtual void set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors);
+    virtual void fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y, const unsigned z,
+                               const std::optional<Voxel> &voxel);
+    virtual void get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const;
+    // Extent of the blocks the storage keeps contiguous, meshers visit voxels block by block in this size.
+    virtual glm::uvec3 get_tile_size() const;
+    // Hash of the size and every voxel, equal for equal grids of one backend. Backends may hash their storage directly,
+    // so equal grids of different backends do not necessarily hash equal.
+    virtual uint64_t hash_contents() const;
+    unsigned fill_box(const glm::uvec3 &begin, const glm::uvec3 &end, const std::optional<Voxel> &voxel);
+    unsigned fill_function(const std::function<std::optional<Voxel>(unsigned, unsigned, unsigned)> &function);
     unsigned fill_cuboid(const Voxel &voxel);
     unsigned fill_ellipsoid(const Voxel &voxel);
-    unsigned fill_perlin_noise(const Voxel &voxel, float frequency);
+    unsigned fill_perlin_noise(const Voxel &voxel, float frequency, const uint64_t seed);
+    unsigned fill_colored_noise(const std::vector<Voxel> &colors, float frequency, const uint64_t seed);
+    unsigned fill_checkerboard(const Voxel &voxel);
+    unsigned fill_random(const Voxel &voxel, float density, const uint64_t seed);
+    unsigned fill_terrain(const std::vector<Voxel> &layers, float frequency, const uint64_t seed);
+    unsigned fill_shell(const Voxel &voxel, const unsigned thickness);
+    unsigned fill_walls(const Voxel &voxel, const unsigned spacing);
     unsigned max_size() const;
+    glm::uvec3 get_size() const;
     Mesh meshify_direct() const;
     Mesh meshify_culled() const;
     Mesh meshify_greedy() const;
+    Mesh meshify_culled_exterior() const;
+    Mesh meshify_greedy_exterior() const;
 
   protected:
+    virtual Mesh meshify_culled_faces(const ExteriorMask *exterior) const;
+    virtual Mesh meshify_greedy_faces(const ExteriorMask *exterior) const;
+    // Merges the faces of every slice into quads, `build_mask` fills the faces between `slice - 1` and `slice` along
+    // `dimension` into a mask spanning the two other dimensions in their cyclic order.
+    Mesh meshify_greedy_masks(
+        const std::function<void(unsigned dimension, unsigned slice, Mask2D &mask)> &build_mask) const;
+
     const unsigned size_x;
     const unsigned size_y;
     const unsigned size_z;
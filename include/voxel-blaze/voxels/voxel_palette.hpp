@@ -0,0 +1,105 @@
+#pragma once
+
+#include <bitset>
+#include <voxel-blaze/common.hpp>
+#include <voxel-blaze/voxels/voxel.hpp>
+
+// Colors of the palette indices, index 0 is always empty. Slots count as used once an index refers to them, so the
+// unused slots of an adopted palette can still take new colors.
+class VoxelPalette
+{
+  public:
+    inline const Voxel &operator[](const uint8_t index) const
+    {
+        return colors[index];
+    }
+
+    inline const Palette &get_colors() const
+    {
+        return colors;
+    }
+
+    inline bool empty() const
+    {
+        return end == 1;
+    }
+
+    // Takes over the colors of `palette` without using any slot, indices written afterwards have to be passed to `use`.
+    inline void assign(const Palette &palette)
+    {
+        colors = palette;
+        used.reset();
+        used.set(0);
+        end = 1;
+    }
+
+    inline uint8_t use(const uint8_t index)
+    {
+        used.set(index);
+        end = std::max(end, index + 1u);
+        return index;
+    }
+
+    inline uint8_t find_or_add(const Voxel &voxel)
+    {
+        for (unsigned i = 1; i < end; i++)
+        {
+            if (used[i] && colors[i] == voxel)
+            {
+                return i;
+            }
+        }
+
+        for (unsigned i = 1; i < colors.size(); i++)
+        {
+            if (!used[i])
+            {
+                colors[i] = voxel;
+                return use(i);
+            }
+        }
+
+        throw std::runtime_error("Palette is full");
+    }
+
+  private:
+    Palette colors = {};
+    std::bitset<256> used = 1;
+    // One past the highest used slot.
+    unsigned end = 1;
+};
+
+// Maps indices of a source palette into a target palette, resolving every used color only once.
+class PaletteRemap
+{
+  public:
+    inline PaletteRemap(VoxelPalette &target, const Palette &source)
+        : target(target), source(source), adopt(target.empty())
+    {
+        // An empty target adopts the source and keeps its indices, but only the ones that are actually remapped become
+        // used.
+        if (adopt)
+        {
+            target.assign(source);
+        }
+
+        table.fill(-1);
+        table[0] = 0;
+    }
+
+    inline uint8_t operator()(const uint8_t index)
+    {
+        if (table[index] < 0)
+        {
+            table[index] = adopt ? target.use(index) : target.find_or_add(source[index]);
+        }
+
+        return table[index];
+    }
+
+  private:
+    VoxelPalette &target;
+    const Palette &source;
+    const bool adopt;
+    std::array<int, 256> table;
+};
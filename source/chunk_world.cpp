@@ -0,0 +1,238 @@
+#include <voxel-blaze/chunk_world.hpp>
+#include <voxel-blaze/trace.hpp>
+
+ChunkWorld::ChunkWorld(Generator generate, Upload upload, Release release)
+    : ChunkWorld(std::move(generate), std::move(upload), std::move(release), Settings())
+{
+}
+
+ChunkWorld::ChunkWorld(Generator generate, Upload upload, Release release, const Settings &settings)
+    : generate(std::move(generate)), upload(std::move(upload)), release(std::move(release)), settings(settings),
+      mesh_cache(settings.mesh_cache_bytes)
+{
+}
+
+const ChunkWorld::Stats &ChunkWorld::update(const glm::vec3 &camera_position)
+{
+    TRACE_ZONE("Update chunk world");
+    frame += 1;
+    stats.requested = 0;
+    stats.uploaded = 0;
+    stats.failed = 0;
+
+    pipeline.drain(
+        settings.upload_budget,
+        [&](const uint64_t key, const std::shared_ptr<const Mesh> &mesh) {
+            auto &chunk = chunks.at(key);
+            chunk.pending = false;
+            chunk.mesh_bytes = mesh->view().gpu_bytes();
+            chunk.uploaded = true;
+
+            // Empty chunks are remembered as uploaded so they are not meshed again, but nothing is sent.
+            if (chunk.mesh_bytes > 0)
+            {
+                upload(chunk.position, *mesh);
+            }
+
+            stats.uploaded += 1;
+        },
+        [&](const uint64_t key) {
+            // The grid may be half generated. Failed chunks are kept like empty ones so they are not requested again
+            // every frame, and are generated from scratch once evicted and visible again.
+            auto &chunk = chunks.at(key);
+            chunk.pending = false;
+            chunk.grid.reset();
+            chunk.mesh_bytes = 0;
+            chunk.uploaded = true;
+            stats.failed += 1;
+        });
+
+    const float chunk_size = settings.chunk_size;
+    const glm::ivec3 camera_chunk = glm::ivec3(glm::floor(camera_position / chunk_size));
+    const int reach = std::ceil(settings.view_radius);
+    std::vector<std::pair<float, glm::ivec3>> missing;
+    stats.visible_chunks = 0;
+
+    for (int z = -reach; z <= reach; z++)
+    {
+        for (int y = -reach; y <= reach; y++)
+        {
+            for (int x = -reach; x <= reach; x++)
+            {
+                const glm::ivec3 position = camera_chunk + glm::ivec3(x, y, z);
+                const float distance = glm::length(get_chunk_center(position) - camera_position) / chunk_size;
+
+                if (distance > settings.view_radius)
+                {
+                    continue;
+                }
+
+                stats.visible_chunks += 1;
+                const auto it = chunks.find(calculate_key(position));
+
+                if (it != chunks.end())
+                {
+                    it->second.last_visible = frame;
+                }
+
+                if (it == chunks.end() || (!it->second.uploaded && !it->second.pending))
+                {
+                    missing.push_back({distance, position});
+                }
+            }
+        }
+    }
+
+    // Closest chunks first, the rest waits for a later frame so requests follow the camera.
+    std::sort(missing.begin(), missing.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    stats.missing_chunks = missing.size();
+
+    for (const auto &[distance, position] : missing)
+    {
+        if (pipeline.pending_count() >= settings.max_pending_jobs)
+        {
+            break;
+        }
+
+        auto &chunk = chunks[calculate_key(position)];
+        chunk.position = position;
+        chunk.last_visible = frame;
+        request(chunk);
+    }
+
+    // Visible chunks that are pending still count as missing until their mesh arrives.
+    for (const auto &[key, chunk] : chunks)
+    {
+        if (chunk.last_visible == frame && chunk.pending)
+        {
+            stats.missing_chunks += 1;
+        }
+    }
+
+    evict();
+    return stats;
+}
+
+const ChunkWorld::Stats &ChunkWorld::get_stats() const
+{
+    return stats;
+}
+
+glm::vec3 ChunkWorld::get_chunk_center(const glm::ivec3 &chunk) const
+{
+    return (glm::vec3(chunk) + 0.5f) * float(settings.chunk_size);
+}
+
+const MeshCache &ChunkWorld::get_mesh_cache() const
+{
+    return mesh_cache;
+}
+
+uint64_t ChunkWorld::calculate_key(const glm::ivec3 &chunk)
+{
+    // 21 bits per axis, offset so negative chunks stay distinct.
+    const auto axis = [](const int value) { return uint64_t(value + (1 << 20)) & ((uint64_t(1) << 21) - 1); };
+    return axis(chunk.x) | (axis(chunk.y) << 21) | (axis(chunk.z) << 42);
+}
+
+void ChunkWorld::request(Chunk &chunk)
+{
+    chunk.pending = true;
+    stats.requested += 1;
+
+    // Chunks still resident in CPU memory only need to be meshed again.
+    if (chunk.grid)
+    {
+        pipeline.request(calculate_key(chunk.position), [this, grid = chunk.grid]() { return meshify(*grid); });
+        return;
+    }
+
+    const unsigned size = settings.chunk_size;
+    chunk.grid = std::make_shared<PaletteVoxelGrid>(size, size, size);
+    pipeline.request(calculate_key(chunk.position), [this, grid = chunk.grid, position = chunk.position]() {
+        {
+            PROFILE_ZONE("Generate chunk");
+            generate(position, *grid);
+        }
+
+        return meshify(*grid);
+    });
+}
+
+std::shared_ptr<const Mesh> ChunkWorld::meshify(const PaletteVoxelGrid &grid)
+{
+    // Chunks are meshed without looking at their neighbours, so the contents alone decide the mesh. Chunks with equal
+    // contents share the cached mesh until it is uploaded.
+    return mesh_cache.get(MeshCache::calculate_key(grid, settings.optimize_meshes), [&]() {
+        auto mesh = grid.meshify_greedy();
+        if (settings.optimize_meshes)
+        {
+            mesh.optimize();
+        }
+
+        return mesh;
+    });
+}
+
+void ChunkWorld::evict()
+{
+    PROFILE_ZONE("Evict chunks");
+    const size_t grid_bytes = size_t(settings.chunk_size) * settings.chunk_size * settings.chunk_size + sizeof(Palette);
+    std::vector<Chunk *> order;
+    stats.cpu_chunks = 0;
+    stats.gpu_chunks = 0;
+    stats.gpu_bytes = 0;
+    stats.cpu_evicted = 0;
+    stats.gpu_evicted = 0;
+
+    for (auto &[key, chunk] : chunks)
+    {
+        stats.cpu_chunks += chunk.grid ? 1 : 0;
+        stats.gpu_chunks += chunk.uploaded ? 1 : 0;
+        stats.gpu_bytes += chunk.mesh_bytes;
+        order.push_back(&chunk);
+    }
+
+    stats.cpu_bytes = stats.cpu_chunks * grid_bytes;
+
+    // Least recently visible first. Chunks visible this frame and chunks with a running job are never evicted.
+    std::sort(order.begin(), order.end(),
+              [](const Chunk *a, const Chunk *b) { return a->last_visible < b->last_visible; });
+
+    for (auto chunk : order)
+    {
+        if (chunk->last_visible == frame ||
+            (stats.cpu_bytes <= settings.cpu_budget_bytes && stats.gpu_bytes <= settings.gpu_budget_bytes))
+        {
+            break;
+        }
+
+        if (chunk->grid && !chunk->pending && stats.cpu_bytes > settings.cpu_budget_bytes)
+        {
+            chunk->grid.reset();
+            stats.cpu_chunks -= 1;
+            stats.cpu_bytes -= grid_bytes;
+            stats.cpu_evicted += 1;
+        }
+
+        if (chunk->uploaded && stats.gpu_bytes > settings.gpu_budget_bytes)
+        {
+            if (chunk->mesh_bytes > 0)
+            {
+                release(chunk->position);
+            }
+
+            chunk->uploaded = false;
+            stats.gpu_chunks -= 1;
+            stats.gpu_bytes -= chunk->mesh_bytes;
+            stats.gpu_evicted += 1;
+            chunk->mesh_bytes = 0;
+        }
+    }
+
+    for (auto it = chunks.begin(); it != chunks.end();)
+    {
+        const auto &chunk = it->second;
+        it = !chunk.grid && !chunk.uploaded && !chunk.pending ? chunks.erase(it) : std::next(it);
+    }
+}
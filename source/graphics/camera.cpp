@@ -2,10 +2,16 @@
 
 void Camera::look_at(const glm::vec3 &position, const glm::vec3 &target)
 {
+    this->position = position;
     view_matrix = glm::lookAt(position, target, glm::vec3(0.0f, 1.0f, 0.0f));
 }
 
  const float *const Camera::matrix_ptr() const
  {
     return glm::value_ptr(view_matrix);
- }
\ No newline at end of file
+ }
+
+glm::vec3 Camera::get_position() const
+{
+    return position;
+}
@@ -0,0 +1,55 @@
+#include <voxel-blaze/graphics/lod_model.hpp>
+
+LodModel::LodModel(const std::vector<Mesh> &meshes)
+{
+    for (const auto &mesh : meshes)
+    {
+        levels.push_back(std::make_unique<Model>(mesh));
+    }
+}
+
+LodModel::LodModel(const size_t level_count) : levels(level_count)
+{
+}
+
+void LodModel::set_level(const size_t level, const Mesh &mesh)
+{
+    levels.at(level) = std::make_unique<Model>(mesh);
+}
+
+bool LodModel::has_level(const size_t level) const
+{
+    return level < levels.size() && levels[level] != nullptr;
+}
+
+void LodModel::translate(const glm::vec3 translations)
+{
+    transform = glm::translate(transform, translations);
+}
+
+void LodModel::rotate(const glm::vec3 angles)
+{
+    transform = glm::rotate(transform, angles.x, glm::vec3(1.0, 0.0, 0.0));
+    transform = glm::rotate(transform, angles.y, glm::vec3(0.0, 1.0, 0.0));
+    transform = glm::rotate(transform, angles.z, glm::vec3(0.0, 0.0, 1.0));
+}
+
+glm::mat4 LodModel::get_tranform() const
+{
+    return transform;
+}
+
+glm::mat4 LodModel::get_level_transform(const size_t level) const
+{
+    return glm::scale(transform, glm::vec3(float(1u << level)));
+}
+
+size_t LodModel::level_count() const
+{
+    return levels.size();
+}
+
+const Model &LodModel::get_level(const size_t level) const
+{
+    return *levels.at(level);
+}
@@ -0,0 +1,486 @@
+#include <fmt/format.h>
+#include <voxel-blaze/graphics/mesh.hpp>
+#include <voxel-blaze/trace.hpp>
+
+namespace
+{
+    static_assert(sizeof(Vertex) == 6 * sizeof(float), "Vertices are written to binary formats as is");
+
+    // Formats output into a memory buffer that is written to the file in large blocks.
+    class BufferedFile
+    {
+      public:
+        static constexpr size_t flush_size = 1 << 20;
+
+        fmt::memory_buffer buffer;
+
+        inline BufferedFile(const std::string &path) : file(path, std::ios::binary)
+        {
+            if (!file.is_open())
+            {
+                throw std::runtime_error("Unable to open file");
+            }
+        }
+
+        inline void append(const void *data, const size_t size)
+        {
+            const char *bytes = static_cast<const char *>(data);
+            buffer.append(bytes, bytes + size);
+        }
+
+        inline void flush_if_full()
+        {
+            if (buffer.size() >= flush_size)
+            {
+                flush();
+            }
+        }
+
+        inline void flush()
+        {
+            file.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+
+        // Large arrays bypass the buffer.
+        inline void write(const void *data, const size_t size)
+        {
+            flush();
+            file.write(static_cast<const char *>(data), size);
+        }
+
+        inline void close()
+        {
+            flush();
+            file.close();
+        }
+
+      private:
+        std::ofstream file;
+    };
+
+    struct Face
+    {
+        unsigned count;
+        unsigned indices[4];
+    };
+
+    // Merges consecutive triangles sharing an edge into quads, every mesher emits its quads as such pairs.
+    template <typename Function>
+    void for_each_face(const std::vector<unsigned> &indices, Function function)
+    {
+        size_t i = 0;
+
+        while (i + 6 <= indices.size())
+        {
+            const unsigned *first = &indices[i];
+            const unsigned *second = &indices[i + 3];
+            bool merged = false;
+
+            for (unsigned r = 0; r < 3 && !merged; r++)
+            {
+                const unsigned a = first[r];
+                const unsigned b = first[(r + 1) % 3];
+                const unsigned c = first[(r + 2) % 3];
+
+                for (unsigned k = 0; k < 3; k++)
+                {
+                    if (second[k] == a && second[(k + 1) % 3] == c)
+                    {
+                        function(Face{4, {a, b, c, second[(k + 2) % 3]}});
+                        merged = true;
+                        break;
+                    }
+                }
+            }
+
+            if (merged)
+            {
+                i += 6;
+            }
+            else
+            {
+                function(Face{3, {first[0], first[1], first[2], 0}});
+                i += 3;
+            }
+        }
+
+        if (i + 3 <= indices.size())
+        {
+            function(Face{3, {indices[i], indices[i + 1], indices[i + 2], 0}});
+        }
+    }
+
+    // Index into the six axis aligned normals written to OBJ files, starting at one.
+    unsigned axis_normal(const std::vector<Vertex> &vertices, const Face &face)
+    {
+        const auto &v0 = vertices[face.indices[0]];
+        const auto &v1 = vertices[face.indices[1]];
+        const auto &v2 = vertices[face.indices[2]];
+        const glm::vec3 normal = glm::cross(glm::vec3(v1.x - v0.x, v1.y - v0.y, v1.z - v0.z),
+                                            glm::vec3(v2.x - v0.x, v2.y - v0.y, v2.z - v0.z));
+
+        const float abs_x = std::fabs(normal.x);
+        const float abs_y = std::fabs(normal.y);
+        const float abs_z = std::fabs(normal.z);
+
+        if (abs_x >= abs_y && abs_x >= abs_z)
+        {
+            return normal.x >= 0.0f ? 1 : 2;
+        }
+        else if (abs_y >= abs_z)
+        {
+            return normal.y >= 0.0f ? 3 : 4;
+        }
+
+        return normal.z >= 0.0f ? 5 : 6;
+    }
+}
+
+ShortIndexMesh ShortIndexMesh::build(const MeshView &mesh, const size_t max_vertex_count)
+{
+    PROFILE_ZONE("Compact indices");
+    ShortIndexMesh result;
+    result.indices.reserve(mesh.index_count);
+    result.vertices.reserve(mesh.vertex_count);
+
+    // Vertices whose stamp matches the current chunk already have a local index in it.
+    std::vector<uint32_t> stamps(mesh.vertex_count, 0);
+    std::vector<uint16_t> local(mesh.vertex_count);
+    uint32_t stamp = 1;
+    MeshChunk chunk = {0, 0, 0, 0};
+
+    for (size_t i = 0; i + 3 <= mesh.index_count; i += 3)
+    {
+        const unsigned a = mesh.indices[i];
+        const unsigned b = mesh.indices[i + 1];
+        const unsigned c = mesh.indices[i + 2];
+        const unsigned added = (stamps[a] != stamp) + (stamps[b] != stamp && b != a) +
+                               (stamps[c] != stamp && c != a && c != b);
+
+        if (chunk.vertex_count + added > max_vertex_count)
+        {
+            result.chunks.push_back(chunk);
+            chunk = {uint32_t(result.vertices.size()), 0, uint32_t(result.indices.size()), 0};
+            stamp++;
+        }
+
+        for (const auto vertex : {a, b, c})
+        {
+            if (stamps[vertex] != stamp)
+            {
+                stamps[vertex] = stamp;
+                local[vertex] = chunk.vertex_count++;
+                result.vertices.push_back(mesh.vertices[vertex]);
+            }
+
+            result.indices.push_back(local[vertex]);
+            chunk.index_count++;
+        }
+    }
+
+    if (chunk.index_count > 0)
+    {
+        result.chunks.push_back(chunk);
+    }
+
+    return result;
+}
+
+void Mesh::optimize(const unsigned cache_size)
+{
+    PROFILE_ZONE("Optimize mesh");
+    const size_t triangle_count = indices.size() / 3;
+    const size_t vertex_count = vertices.size();
+
+    // Triangles around every vertex as ranges of one list, and how many of them are not emitted yet.
+    std::vector<uint32_t> offsets(vertex_count + 1, 0);
+    std::vector<uint32_t> live(vertex_count, 0);
+    std::vector<uint32_t> adjacency(triangle_count * 3);
+
+    for (size_t i = 0; i < triangle_count * 3; i++)
+    {
+        live[indices[i]]++;
+    }
+
+    for (size_t vertex = 0; vertex < vertex_count; vertex++)
+    {
+        offsets[vertex + 1] = offsets[vertex] + live[vertex];
+    }
+
+    {
+        std::vector<uint32_t> ends(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangle_count * 3; i++)
+        {
+            adjacency[ends[indices[i]]++] = i / 3;
+        }
+    }
+
+    // A vertex is in the cache while fewer than `cache_size` vertices entered after it.
+    std::vector<uint32_t> cache_times(vertex_count, 0);
+    std::vector<char> emitted(triangle_count, 0);
+    std::vector<uint32_t> dead_ends;
+    std::vector<uint32_t> candidates;
+    std::vector<unsigned> ordered;
+    ordered.reserve(triangle_count * 3);
+    uint32_t time = cache_size + 1;
+    size_t cursor = 0;
+
+    const auto next_vertex = [&]() -> int64_t {
+        // Prefer the candidate that stays in the cache for all its remaining triangles and entered it earliest.
+        int64_t best = -1;
+        int64_t best_priority = -1;
+
+        for (const auto vertex : candidates)
+        {
+            if (live[vertex] == 0)
+            {
+                continue;
+            }
+
+            const int64_t age = time - cache_times[vertex];
+            const int64_t priority = age + 2 * live[vertex] <= cache_size ? age : 0;
+
+            if (priority > best_priority)
+            {
+                best = vertex;
+                best_priority = priority;
+            }
+        }
+
+        if (best >= 0)
+        {
+            return best;
+        }
+
+        // Dead end, continue at a recently used vertex or else at the first one with triangles left.
+        while (!dead_ends.empty())
+        {
+            const auto vertex = dead_ends.back();
+            dead_ends.pop_back();
+
+            if (live[vertex] > 0)
+            {
+                return vertex;
+            }
+        }
+
+        for (; cursor < vertex_count; cursor++)
+        {
+            if (live[cursor] > 0)
+            {
+                return cursor;
+            }
+        }
+
+        return -1;
+    };
+
+    for (int64_t fanning = next_vertex(); fanning >= 0; fanning = next_vertex())
+    {
+        candidates.clear();
+
+        for (uint32_t i = offsets[fanning]; i < offsets[fanning + 1]; i++)
+        {
+            const auto triangle = adjacency[i];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+
+            emitted[triangle] = 1;
+
+            for (unsigned corner = 0; corner < 3; corner++)
+            {
+                const auto vertex = indices[triangle * 3 + corner];
+                ordered.push_back(vertex);
+                dead_ends.push_back(vertex);
+                candidates.push_back(vertex);
+                live[vertex]--;
+
+                if (time - cache_times[vertex] > cache_size)
+                {
+                    cache_times[vertex] = time++;
+                }
+            }
+        }
+    }
+
+    // Vertices in order of first use, so the vertex fetch walks the buffer mostly sequentially.
+    std::vector<uint32_t> remap(vertex_count, std::numeric_limits<uint32_t>::max());
+    std::vector<Vertex> fetched;
+    fetched.reserve(vertex_count);
+
+    for (auto &index : ordered)
+    {
+        if (remap[index] == std::numeric_limits<uint32_t>::max())
+        {
+            remap[index] = fetched.size();
+            fetched.push_back(vertices[index]);
+        }
+
+        index = remap[index];
+    }
+
+    indices = std::move(ordered);
+    vertices = std::move(fetched);
+}
+
+VertexCacheStats Mesh::analyze_vertex_cache(const unsigned cache_size) const
+{
+    const size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+    {
+        return VertexCacheStats{};
+    }
+
+    // A vertex is cached while fewer than `cache_size` misses happened after its own.
+    std::vector<uint64_t> miss_times(vertices.size(), 0);
+    std::vector<char> referenced(vertices.size(), 0);
+    uint64_t misses = 0;
+    size_t referenced_count = 0;
+
+    for (size_t i = 0; i < triangle_count * 3; i++)
+    {
+        const auto vertex = indices[i];
+
+        if (cache_size + misses - miss_times[vertex] >= cache_size)
+        {
+            misses++;
+            miss_times[vertex] = cache_size + misses;
+        }
+
+        referenced_count += referenced[vertex] ? 0 : 1;
+        referenced[vertex] = 1;
+    }
+
+    return VertexCacheStats{double(misses) / triangle_count, double(misses) / referenced_count};
+}
+
+void Mesh::save_obj(const std::string &path) const
+{
+    TRACE_ZONE("Export OBJ");
+    BufferedFile file(path);
+    auto out = fmt::appender(file.buffer);
+
+    fmt::format_to(out, "vn 1 0 0\nvn -1 0 0\nvn 0 1 0\nvn 0 -1 0\nvn 0 0 1\nvn 0 0 -1\n");
+
+    // Vertex colors follow the positions, as understood by most tools.
+    for (const auto &vertex : vertices)
+    {
+        fmt::format_to(out, "v {} {} {} {} {} {}\n", vertex.x, vertex.y, vertex.z, vertex.r, vertex.g, vertex.b);
+        file.flush_if_full();
+    }
+
+    for_each_face(indices, [&](const Face &face) {
+        const auto normal = axis_normal(vertices, face);
+
+        if (face.count == 4)
+        {
+            fmt::format_to(out, "f {}//{} {}//{} {}//{} {}//{}\n", face.indices[0] + 1, normal, face.indices[1] + 1,
+                           normal, face.indices[2] + 1, normal, face.indices[3] + 1, normal);
+        }
+        else
+        {
+            fmt::format_to(out, "f {}//{} {}//{} {}//{}\n", face.indices[0] + 1, normal, face.indices[1] + 1, normal,
+                           face.indices[2] + 1, normal);
+        }
+
+        file.flush_if_full();
+    });
+
+    file.close();
+}
+
+void Mesh::save_ply(const std::string &path) const
+{
+    TRACE_ZONE("Export PLY");
+    size_t face_count = 0;
+    for_each_face(indices, [&face_count](const Face &) { face_count += 1; });
+
+    BufferedFile file(path);
+    fmt::format_to(fmt::appender(file.buffer),
+                   "ply\nformat binary_little_endian 1.0\nelement vertex {}\nproperty float x\nproperty float y\n"
+                   "property float z\nproperty float red\nproperty float green\nproperty float blue\n"
+                   "element face {}\nproperty list uchar uint vertex_indices\nend_header\n",
+                   vertices.size(), face_count);
+
+    file.write(vertices.data(), vertices.size() * sizeof(Vertex));
+
+    for_each_face(indices, [&file](const Face &face) {
+        const uint8_t count = face.count;
+        file.append(&count, sizeof(count));
+        file.append(face.indices, face.count * sizeof(unsigned));
+        file.flush_if_full();
+    });
+
+    file.close();
+}
+
+void Mesh::save_glb(const std::string &path) const
+{
+    TRACE_ZONE("Export GLB");
+    const uint32_t vertices_size = vertices.size() * sizeof(Vertex);
+    const uint32_t indices_size = indices.size() * sizeof(unsigned);
+
+    glm::vec3 min(0.0f);
+    glm::vec3 max(0.0f);
+
+    if (!vertices.empty())
+    {
+        min = max = glm::vec3(vertices[0].x, vertices[0].y, vertices[0].z);
+    }
+
+    for (const auto &vertex : vertices)
+    {
+        min = glm::min(min, glm::vec3(vertex.x, vertex.y, vertex.z));
+        max = glm::max(max, glm::vec3(vertex.x, vertex.y, vertex.z));
+    }
+
+    // Accessors may not be empty, an empty mesh becomes an empty scene.
+    const bool has_binary = !vertices.empty() && !indices.empty();
+    std::string json;
+
+    if (!has_binary)
+    {
+        json = R"({"asset":{"version":"2.0","generator":"Voxel Blaze"},"scene":0,"scenes":[{"nodes":[]}]})";
+    }
+    else
+    {
+        json = fmt::format(
+            R"({{"asset":{{"version":"2.0","generator":"Voxel Blaze"}},"scene":0,"scenes":[{{"nodes":[0]}}],)"
+            R"("nodes":[{{"mesh":0}}],"meshes":[{{"primitives":[{{"attributes":{{"POSITION":0,"COLOR_0":1}},)"
+            R"("indices":2,"mode":4}}]}}],"buffers":[{{"byteLength":{}}}],"bufferViews":[)"
+            R"({{"buffer":0,"byteOffset":0,"byteLength":{},"byteStride":{},"target":34962}},)"
+            R"({{"buffer":0,"byteOffset":{},"byteLength":{},"target":34963}}],"accessors":[)"
+            R"({{"bufferView":0,"byteOffset":0,"componentType":5126,"count":{},"type":"VEC3",)"
+            R"("min":[{},{},{}],"max":[{},{},{}]}},)"
+            R"({{"bufferView":0,"byteOffset":12,"componentType":5126,"count":{},"type":"VEC3"}},)"
+            R"({{"bufferView":1,"byteOffset":0,"componentType":5125,"count":{},"type":"SCALAR"}}]}})",
+            vertices_size + indices_size, vertices_size, sizeof(Vertex), vertices_size, indices_size,
+            vertices.size(), min.x, min.y, min.z, max.x, max.y, max.z, vertices.size(), indices.size());
+    }
+
+    // Chunks have to be padded to four bytes, JSON with spaces.
+    json.append((4 - json.size() % 4) % 4, ' ');
+
+    const uint32_t json_size = json.size();
+    const uint32_t binary_size = vertices_size + indices_size;
+    const uint32_t total_size = 12 + 8 + json_size + (has_binary ? 8 + binary_size : 0);
+    const uint32_t header[] = {0x46546C67, 2, total_size, json_size, 0x4E4F534A};
+
+    BufferedFile file(path);
+    file.append(header, sizeof(header));
+    file.append(json.data(), json.size());
+
+    if (has_binary)
+    {
+        // Vertex and index sizes are multiples of four already.
+        const uint32_t binary_header[] = {binary_size, 0x004E4942};
+        file.append(binary_header, sizeof(binary_header));
+        file.write(vertices.data(), vertices_size);
+        file.write(indices.data(), indices_size);
+    }
+
+    file.close();
+}
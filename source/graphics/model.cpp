@@ -1,42 +1,52 @@
 #include <voxel-blaze/graphics/model.hpp>
 #include <voxel-blaze/graphics/shader.hpp>
+#include <voxel-blaze/trace.hpp>
 
-Model::Model(const Mesh &mesh) : vertex_count(mesh.indices.size())
+Model::Model(const Mesh &mesh) : Model(mesh.view())
 {
+}
+
+Model::Model(const MeshView &mesh) : vertex_count(mesh.index_count)
+{
+    TRACE_ZONE("Upload model");
     if (vertex_count == 0)
     {
         spdlog::warn("There are no vertices in the provided mesh");
     }
 
-    // Prepare vertex buffer.
-    glGenBuffers(1, &vertex_buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(Vertex), &mesh.vertices[0], GL_STATIC_DRAW);
+    // Small meshes only narrow their indices. Larger ones are split into chunks when the vertices duplicated at chunk
+    // borders cost less than the index bytes saved, which mostly holds for meshes ordered for the vertex cache.
+    if (mesh.vertex_count <= MeshView::max_short_vertex_count)
+    {
+        const std::vector<uint16_t> indices(mesh.indices, mesh.indices + mesh.index_count);
+        chunks.push_back(MeshChunk{0, uint32_t(mesh.vertex_count), 0, uint32_t(mesh.index_count)});
+        upload(mesh.vertices, mesh.vertex_count, indices.data(), indices.size());
+        return;
+    }
 
-    // Prepare vertex array.
-    glGenVertexArrays(1, &vertex_array);
-    glBindVertexArray(vertex_array);
+    auto compacted = ShortIndexMesh::build(mesh);
+    const size_t compacted_bytes =
+        compacted.vertices.size() * sizeof(Vertex) + compacted.indices.size() * sizeof(uint16_t);
 
-    // Prepare index buffer.
-    glGenBuffers(1, &index_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned), &mesh.indices[0], GL_STATIC_DRAW);
-
-    // Set up vertex attributes.
-    glEnableVertexAttribArray(0);
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex), (void *)0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(Vertex), (void *)(3 * sizeof(float)));
+    if (compacted_bytes < mesh.vertex_count * sizeof(Vertex) + mesh.index_count * sizeof(unsigned))
+    {
+        chunks = std::move(compacted.chunks);
+        upload(compacted.vertices.data(), compacted.vertices.size(), compacted.indices.data(),
+               compacted.indices.size());
+        return;
+    }
 
-    // Clean up.
-    glBindVertexArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    index_type = GL_UNSIGNED_INT;
+    index_size = sizeof(unsigned);
+    chunks.push_back(MeshChunk{0, uint32_t(mesh.vertex_count), 0, uint32_t(mesh.index_count)});
+    upload(mesh.vertices, mesh.vertex_count, mesh.indices, mesh.index_count);
 }
 
 Model::~Model()
 {
     glDeleteVertexArrays(1, &vertex_array);
     glDeleteBuffers(1, &vertex_buffer);
+    glDeleteBuffers(1, &index_buffer);
 }
 
 void Model::translate(const glm::vec3 translations)
@@ -54,4 +64,38 @@ void Model::rotate(const glm::vec3 angles)
 glm::mat4 Model::get_tranform() const
 {
     return transform;
+}
+
+size_t Model::get_gpu_bytes() const
+{
+    return gpu_bytes;
+}
+
+void Model::upload(const Vertex *vertices, const size_t vertex_count, const void *indices, const size_t index_count)
+{
+    gpu_bytes = vertex_count * sizeof(Vertex) + index_count * index_size;
+
+    // Prepare vertex buffer.
+    glGenBuffers(1, &vertex_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, vertex_count * sizeof(Vertex), vertices, GL_STATIC_DRAW);
+
+    // Prepare vertex array.
+    glGenVertexArrays(1, &vertex_array);
+    glBindVertexArray(vertex_array);
+
+    // Prepare index buffer.
+    glGenBuffers(1, &index_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_count * index_size, indices, GL_STATIC_DRAW);
+
+    // Set up vertex attributes.
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vertex), (void *)0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, false, sizeof(Vertex), (void *)(3 * sizeof(float)));
+
+    // Clean up.
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
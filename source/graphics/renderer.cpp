@@ -1,8 +1,10 @@
 #include <voxel-blaze/graphics/renderer.hpp>
+#include <voxel-blaze/profiler.hpp>
 
 Renderer::Renderer(Shader &&shader) : shader(std::move(shader))
 {
-    auto projection_transform = glm::perspective(glm::radians(45.0f), 1280.0f / 1280.0f, 0.1f, 10000.0f);
+    auto projection_transform =
+        glm::perspective(glm::radians(field_of_view), 1280.0f / viewport_height, 0.1f, 10000.0f);
     this->shader.upload_transform("projection_transform", glm::value_ptr(projection_transform));
 
     glEnable(GL_CULL_FACE);
@@ -14,15 +16,58 @@ Renderer::Renderer(Shader &&shader) : shader(std::move(shader))
 
 float Renderer::draw(const Camera &camera, const Model &model)
 {
+    return draw(camera, model, model.get_tranform());
+}
+
+float Renderer::draw(const Camera &camera, const LodModel &model)
+{
+    const auto selected = select_level(camera, model);
+
+    // Levels still being meshed are replaced by the closest uploaded one, finer levels first.
+    for (size_t distance = 0; distance < model.level_count(); distance++)
+    {
+        for (const auto level : {selected - distance, selected + distance})
+        {
+            if (model.has_level(level))
+            {
+                return draw(camera, model.get_level(level), model.get_level_transform(level));
+            }
+        }
+    }
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return 0.0f;
+}
+
+size_t Renderer::select_level(const Camera &camera, const LodModel &model) const
+{
+    // Pixels covered by one full resolution voxel at the distance of the model's origin.
+    const glm::vec3 origin = glm::vec3(model.get_tranform()[3]);
+    const float distance = std::max(glm::length(camera.get_position() - origin), 0.1f);
+    const float pixels_per_voxel = viewport_height / (2.0f * distance * std::tan(glm::radians(field_of_view) / 2.0f));
+
+    // Level `i` voxels are `2^i` times larger, take the coarsest level that still stays below the threshold.
+    const float level = std::floor(std::log2(lod_pixel_threshold / pixels_per_voxel));
+    return std::clamp<float>(level, 0.0f, model.level_count() - 1.0f);
+}
+
+float Renderer::draw(const Camera &camera, const Model &model, const glm::mat4 &transform)
+{
+    PROFILE_ZONE("Draw");
     this->shader.upload_transform("view_transform", camera.matrix_ptr());
-    this->shader.upload_transform("model_transform", glm::value_ptr(model.get_tranform()));
+    this->shader.upload_transform("model_transform", glm::value_ptr(transform));
 
     const auto start_time = std::chrono::high_resolution_clock::now();
 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glUseProgram(shader.handle);
     glBindVertexArray(model.vertex_array);
-    glDrawElements(GL_TRIANGLES, model.vertex_count, GL_UNSIGNED_INT, nullptr);
+    for (const auto &chunk : model.chunks)
+    {
+        glDrawElementsBaseVertex(GL_TRIANGLES, chunk.index_count, model.index_type,
+                                 (void *)(chunk.index_offset * model.index_size), chunk.vertex_offset);
+    }
+
     glBindVertexArray(0);
     glUseProgram(0);
 
@@ -4,318 +4,91 @@
 #include <voxel-blaze/graphics/renderer.hpp>
 #include <voxel-blaze/graphics/shader.hpp>
 #include <voxel-blaze/graphics/window.hpp>
-#include <voxel-blaze/parsers/vox_parser.hpp>
+#include <voxel-blaze/mesh_pipeline.hpp>
+#include <voxel-blaze/profiler.hpp>
+#include <voxel-blaze/scenes.hpp>
 #include <voxel-blaze/voxels/array_voxel_grid.hpp>
+#include <voxel-blaze/voxels/lod_pyramid.hpp>
 
-// TODO Handle VOX file with multiple "frames".
 // TODO Handle alpha transparency.
 // TODO Implement orbit camera.
 
 const unsigned cubic_size = 64;
-const auto locale = std::locale("");
+// Finished meshes are uploaded for at most this long per frame, so remeshing never stalls rendering.
+const auto upload_budget = std::chrono::milliseconds(2);
 
-struct Timer
+// Generates the scene for `seed` and queues meshing of every LOD level, keyed by level. Returns the level count.
+size_t request_scene(MeshPipeline &pipeline, const uint64_t seed)
 {
-    std::chrono::high_resolution_clock::time_point start_point = std::chrono::high_resolution_clock::now();
+    auto grid = std::make_shared<ArrayVoxelGrid>(cubic_size, cubic_size, cubic_size);
+    SceneLibrary(seed).get_scene("noise").fill(*grid);
+    const auto pyramid = std::make_shared<const LodPyramid>(*grid);
 
-    inline void start()
+    // Coarse levels are queued first, they finish quickly and fill in until the finer ones are done. Jobs share the
+    // grid and its pyramid, both stay alive until the last level is meshed.
+    for (size_t level = pyramid->level_count(); level-- > 0;)
     {
-        start_point = std::chrono::high_resolution_clock::now();
+        pipeline.request(level, [grid, pyramid, level]() {
+            auto mesh = pyramid->get_level(level).meshify_greedy();
+            mesh.optimize();
+            return std::make_shared<const Mesh>(std::move(mesh));
+        });
     }
 
-    inline std::chrono::nanoseconds round() const
-    {
-        auto end_point = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end_point - start_point);
-        return duration;
-    }
-
-    static std::string format_duration(std::chrono::nanoseconds duration)
-    {
-        using namespace std::chrono;
-
-        auto ns_count = duration.count();
-
-        if (ns_count < 1000)
-        {
-            return std::to_string(ns_count) + "ns";
-        }
-        else if (ns_count < 1000 * 1000)
-        {
-            double us = ns_count / 1000.0;
-            std::stringstream ss;
-            ss << std::fixed << std::setprecision(3) << us << "µs";
-            return ss.str();
-        }
-        else if (ns_count < 1000 * 1000 * 1000)
-        {
-            double ms = ns_count / (1000.0 * 1000.0);
-            std::stringstream ss;
-            ss << std::fixed << std::setprecision(3) << ms << "ms";
-            return ss.str();
-        }
-        else
-        {
-            double sec = ns_count / (1000.0 * 1000.0 * 1000.0);
-            std::stringstream ss;
-            ss << std::fixed << std::setprecision(3) << sec << "s";
-            return ss.str();
-        }
-    }
-};
-
-struct Result
-{
-    std::string name;
-    unsigned size;
-    size_t vertex_count;
-    size_t face_count;
-    std::chrono::nanoseconds duration;
-
-    inline void print(std::ostream &ostream, unsigned col_width, char delim) const
-    {
-        ostream << std::setw(col_width * 3) << name << delim;
-        ostream << std::setw(col_width) << size << delim;
-        ostream << std::setw(col_width) << vertex_count << delim;
-        ostream << std::setw(col_width) << face_count << delim;
-        ostream << std::setw(col_width) << Timer::format_duration(duration) << delim;
-        ostream << "\n";
-    }
-
-    inline void print_compare(std::ostream &ostream, unsigned col_width, char delim, const Result &other) const
-    {
-        auto ratio_vertex_count = (double)vertex_count / (double)other.vertex_count;
-        auto ratio_face_count = (double)face_count / (double)other.face_count;
-        auto ratio_duration = (double)duration.count() / (double)other.duration.count();
-
-        ratio_vertex_count = (ratio_vertex_count - 1.0) * 100.0;
-        ratio_face_count = (ratio_face_count - 1.0) * 100.0;
-        ratio_duration = (ratio_duration - 1.0) * 100.0;
-
-        ostream << std::setw(col_width * 3) << (name + " comp to " + other.name) << delim;
-        ostream << std::setw(col_width) << size << delim;
-        ostream << std::setw(col_width) << std::fixed << std::setprecision(2) << (ratio_vertex_count > 0 ? "+" : "")
-                << ratio_vertex_count << "%" << delim;
-        ostream << std::setw(col_width) << std::fixed << std::setprecision(2) << (ratio_face_count > 0 ? "+" : "")
-                << ratio_face_count << "%" << delim;
-        ostream << std::setw(col_width) << std::fixed << std::setprecision(2) << (ratio_duration > 0 ? "+" : "")
-                << ratio_duration << "%" << delim;
-        ostream << "\n";
-    }
-
-    static inline void print_sep(std::ostream &ostream)
-    {
-        ostream << "\n";
-    }
-
-    static inline void print_sec(std::ostream &ostream)
-    {
-        ostream << "\n\n";
-    }
-};
+    return pyramid->level_count();
+}
 
-void test_suite()
+int main(int argc, char **argv)
 {
+    spdlog::set_level(spdlog::level::info);
 
-    std::vector<Result> results_direct;
-    std::vector<Result> results_culled;
-    std::vector<Result> results_greedy;
-    std::vector<ArrayVoxelGrid> cuboids;
-    std::vector<ArrayVoxelGrid> ellipsoids;
-    std::vector<ArrayVoxelGrid> noises;
-
-    for (unsigned i = 1; i <= 8; i++)
-    {
-        auto size = glm::pow(2, i);
-        ArrayVoxelGrid cuboid = ArrayVoxelGrid(size, size, size);
-        ArrayVoxelGrid ellipsoid = ArrayVoxelGrid(size, size, size);
-        ArrayVoxelGrid noise = ArrayVoxelGrid(size, size, size);
-        cuboid.fill_cuboid(Voxel{1.0, 1.0, 1.0});
-        ellipsoid.fill_ellipsoid(Voxel{1.0, 1.0, 1.0});
-        noise.fill_perlin_noise(Voxel{1.0, 1.0, 1.0}, 0.05);
-        cuboids.push_back(cuboid);
-        ellipsoids.push_back(ellipsoid);
-        noises.push_back(noise);
-    }
-
-    // Direct
-    Timer timer;
-
-    for (const auto &v : cuboids)
-    {
-        timer.start();
-        const auto mesh = v.meshify_direct();
-        results_direct.push_back(
-            {"direct cuboid", v.max_size(), mesh.vertices.size(), mesh.indices.size() / 3, timer.round()});
-    }
-
-    for (const auto &v : ellipsoids)
-    {
-        timer.start();
-        const auto mesh = v.meshify_direct();
-        results_direct.push_back(
-            {"direct ellipsoid", v.max_size(), mesh.vertices.size(), mesh.indices.size() / 3, timer.round()});
-    }
-
-    for (const auto &v : noises)
-    {
-        timer.start();
-        const auto mesh = v.meshify_direct();
-        results_direct.push_back(
-            {"direct noise", v.max_size(), mesh.vertices.size(), mesh.indices.size() / 3, timer.round()});
-    }
-
-    // Culled
-
-    for (const auto &v : cuboids)
-    {
-        timer.start();
-        const auto mesh = v.meshify_culled();
-        results_culled.push_back(
-            {"culled cuboid", v.max_size(), mesh.vertices.size(), mesh.indices.size() / 3, timer.round()});
-    }
-
-    for (const auto &v : ellipsoids)
-    {
-        timer.start();
-        const auto mesh = v.meshify_culled();
-        results_culled.push_back(
-            {"culled ellipsoid", v.max_size(), mesh.vertices.size(), mesh.indices.size() / 3, timer.round()});
-    }
-
-    for (const auto &v : noises)
-    {
-        timer.start();
-        const auto mesh = v.meshify_culled();
-        results_culled.push_back(
-            {"culled noise", v.max_size(), mesh.vertices.size(), mesh.indices.size() / 3, timer.round()});
-    }
-
-    // Greedy
-
-    for (const auto &v : cuboids)
-    {
-        timer.start();
-        const auto mesh = v.meshify_greedy();
-        results_greedy.push_back(
-            {"greedy cuboid", v.max_size(), mesh.vertices.size(), mesh.indices.size() / 3, timer.round()});
-    }
-
-    for (const auto &v : ellipsoids)
-    {
-        timer.start();
-        const auto mesh = v.meshify_greedy();
-        results_greedy.push_back(
-            {"greedy ellipsoid", v.max_size(), mesh.vertices.size(), mesh.indices.size() / 3, timer.round()});
-    }
-
-    for (const auto &v : noises)
-    {
-        timer.start();
-        const auto mesh = v.meshify_greedy();
-        results_greedy.push_back(
-            {"greedy noise", v.max_size(), mesh.vertices.size(), mesh.indices.size() / 3, timer.round()});
-    }
-
-    // Write results to file
-
-    const auto col_width = 0;
-
-    std::locale comma_locale(std::locale(), new std::numpunct<char>(' ')); // You can use ',' instead of ' ' for comma
-    std::ofstream file("testresults.csv");
-    file.imbue(locale);
-
-    for (const auto &result : results_direct)
-    {
-        result.print(file, col_width, '\t');
-    }
-
-    Result::print_sep(file);
-
-    for (const auto &result : results_culled)
-    {
-        result.print(file, col_width, '\t');
-    }
-
-    Result::print_sep(file);
-
-    for (const auto &result : results_greedy)
-    {
-        result.print(file, col_width, '\t');
-    }
-
-    Result::print_sep(file);
-
-    // Compare
-
-    for (unsigned i = 0; i < results_culled.size(); i++)
-    {
-        const auto result_direct = results_direct[i];
-        const auto result_culled = results_culled[i];
-        result_culled.print_compare(file, col_width, '\t', result_direct);
-    }
-
-    Result::print_sep(file);
-
-    for (unsigned i = 0; i < results_greedy.size(); i++)
-    {
-        const auto result_direct = results_direct[i];
-        const auto result_greedy = results_greedy[i];
-        result_greedy.print_compare(file, col_width, '\t', result_direct);
-    }
-
-    Result::print_sep(file);
-
-    for (unsigned i = 0; i < results_greedy.size(); i++)
+    // Pass `--profile trace.json` to record profiling zones and export them as a Chrome trace on exit.
+    std::string profile_path;
+    if (argc == 3 && std::string(argv[1]) == "--profile")
     {
-        const auto result_culled = results_culled[i];
-        const auto result_greedy = results_greedy[i];
-        result_greedy.print_compare(file, col_width, '\t', result_culled);
+        profile_path = argv[2];
+        Profiler::set_enabled(true);
     }
 
-    file.close();
-}
-
-int main()
-{
-    test_suite();
-    return 0;
-
-    spdlog::set_level(spdlog::level::info);
     Window window(1280, 1280);
     Shader shader(consts::vertex_shader_source, consts::fragment_shader_source);
     Renderer renderer(std::move(shader));
 
     Camera camera;
 
-    VoxParser parser("resources/teapot.vox");
-
-    ArrayVoxelGrid filled = ArrayVoxelGrid(cubic_size, cubic_size, cubic_size);
-    filled.fill_perlin_noise(Voxel{1.0f, 1.0f, 1.0f}, 0.05);
-    const auto voxel_grid = parser.get_voxel_grid();
-    // Model model = voxel_grid->meshify_culled();
-
-    Mesh mesh = filled.meshify_greedy();
-
-    mesh.save_obj("test.obj");
-    Model model = Model(mesh);
+    // Meshing runs on the pipeline's workers, so the first frames are drawn right away.
+    MeshPipeline pipeline;
+    uint64_t seed = SceneLibrary::default_seed;
+    LodModel model(request_scene(pipeline, seed));
     model.rotate(glm::vec3(-glm::pi<float>() / 2.0f, 0.0f, 0.0f));
+    bool regenerate_held = false;
+    bool exported = false;
 
-    // auto voxel_grid = ArrayVoxelGrid(cubic_size, cubic_size, cubic_size);
-    // voxel_grid.fill_ellipsoid(Voxel{1.0f, 1.0f, 1.0f});
-    // // voxel_grid.set_voxel(0, 0, 0, std::nullopt);
-    // // voxel_grid.set_voxel(0, 1, 0, std::nullopt);
-    // // voxel_grid.set_voxel(0, cubic_size / 2, cubic_size / 2, std::nullopt);
-    // auto model = Model(voxel_grid.meshify_greedy());
-    // //model.translate(glm::vec3(cubic_size / 2, cubic_size / 2, cubic_size / 2));
-
-    camera.look_at(glm::vec3(cubic_size / 2, cubic_size / 2, voxel_grid->max_size() * 1.5f), glm::vec3(0));
+    camera.look_at(glm::vec3(cubic_size / 2, cubic_size / 2, cubic_size * 1.5f), glm::vec3(0));
 
     while (window.opened())
     {
+        pipeline.drain(upload_budget, [&](const uint64_t level, const std::shared_ptr<const Mesh> &mesh) {
+            // The first full resolution mesh is exported once, here rather than on a worker so writes never overlap.
+            if (level == 0 && !exported)
+            {
+                mesh->save_obj("test.obj");
+                exported = true;
+            }
+
+            model.set_level(level, *mesh);
+        });
+
         const auto delta_time = renderer.draw(camera, model);
         const auto speed = delta_time * 0.05f;
 
+        // R remeshes the next seed in the background, the current levels stay until they are replaced.
+        if (window.key_down(GLFW_KEY_R) && !regenerate_held)
+        {
+            request_scene(pipeline, ++seed);
+        }
+        regenerate_held = window.key_down(GLFW_KEY_R);
+
         if (window.key_down(GLFW_KEY_Q))
         {
             if (window.key_down(GLFW_KEY_LEFT_SHIFT))
@@ -350,4 +123,9 @@ int main()
             }
         }
     }
+
+    if (!profile_path.empty())
+    {
+        Profiler::write_chrome_trace(profile_path);
+    }
 }
@@ -0,0 +1,70 @@
+#include <voxel-blaze/hash.hpp>
+#include <voxel-blaze/mesh_cache.hpp>
+#include <voxel-blaze/trace.hpp>
+
+MeshCache::MeshCache(const size_t budget_bytes) : budget_bytes(budget_bytes)
+{
+}
+
+uint64_t MeshCache::calculate_key(const VoxelGrid &grid, const uint64_t variant)
+{
+    PROFILE_ZONE("Hash grid contents");
+    return grid.hash_contents() ^ hash_mix(variant);
+}
+
+size_t MeshCache::calculate_bytes(const Mesh &mesh)
+{
+    return mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * sizeof(unsigned);
+}
+
+std::shared_ptr<const Mesh> MeshCache::get(const uint64_t key, const std::function<Mesh()> &meshify)
+{
+    {
+        const std::lock_guard lock(mutex);
+        const auto it = lookup.find(key);
+
+        if (it != lookup.end())
+        {
+            const auto &entry = *it->second;
+            entries.splice(entries.begin(), entries, it->second);
+            stats.hits++;
+            stats.saved_bytes += entry.bytes;
+            stats.saved_time += entry.time;
+            return entry.mesh;
+        }
+
+        stats.misses++;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto mesh = std::make_shared<const Mesh>(meshify());
+    const auto time = std::chrono::steady_clock::now() - start;
+
+    const std::lock_guard lock(mutex);
+
+    // Another thread meshed the same contents in the meantime.
+    if (lookup.count(key) != 0)
+    {
+        return mesh;
+    }
+
+    entries.push_front(Entry{key, mesh, calculate_bytes(*mesh), time});
+    lookup[key] = entries.begin();
+    stats.bytes += entries.front().bytes;
+
+    while (stats.bytes > budget_bytes && !entries.empty())
+    {
+        stats.bytes -= entries.back().bytes;
+        lookup.erase(entries.back().key);
+        entries.pop_back();
+    }
+
+    stats.entries = entries.size();
+    return mesh;
+}
+
+MeshCache::Stats MeshCache::get_stats() const
+{
+    const std::lock_guard lock(mutex);
+    return stats;
+}
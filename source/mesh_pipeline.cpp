@@ -0,0 +1,163 @@
+#include <voxel-blaze/mesh_pipeline.hpp>
+#include <voxel-blaze/trace.hpp>
+
+MeshPipeline::MeshPipeline(const unsigned worker_count)
+{
+    for (unsigned i = 0; i < std::max(1u, worker_count); i++)
+    {
+        workers.emplace_back(&MeshPipeline::work, this);
+    }
+}
+
+MeshPipeline::~MeshPipeline()
+{
+    {
+        const std::lock_guard lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+
+    wake.notify_all();
+
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void MeshPipeline::request(const uint64_t key, std::function<std::shared_ptr<const Mesh>()> job)
+{
+    {
+        const std::lock_guard lock(mutex);
+        const uint64_t version = ++next_version;
+        latest_versions[key] = version;
+
+        // A queued job of the same key is replaced in place, so it keeps its turn.
+        const auto queued =
+            std::find_if(jobs.begin(), jobs.end(), [&](const Job &queued) { return queued.key == key; });
+
+        if (queued != jobs.end())
+        {
+            *queued = Job{key, version, std::move(job)};
+            return;
+        }
+
+        jobs.push_back(Job{key, version, std::move(job)});
+    }
+
+    wake.notify_one();
+}
+
+size_t MeshPipeline::drain(const std::chrono::microseconds budget,
+                           const std::function<void(uint64_t key, const std::shared_ptr<const Mesh> &mesh)> &consume,
+                           const std::function<void(uint64_t key)> &fail)
+{
+    PROFILE_ZONE("Drain meshes");
+    const auto start = std::chrono::steady_clock::now();
+    size_t count = 0;
+
+    while (count == 0 || std::chrono::steady_clock::now() - start < budget)
+    {
+        Result result;
+
+        {
+            const std::lock_guard lock(mutex);
+            if (results.empty())
+            {
+                break;
+            }
+
+            result = std::move(results.front());
+            results.pop_front();
+
+            // Nothing newer is queued or running for the key, so it needs no version anymore. Keys of a streaming
+            // world would otherwise accumulate forever.
+            if (is_latest(result.key, result.version))
+            {
+                latest_versions.erase(result.key);
+            }
+        }
+
+        if (!result.failed)
+        {
+            consume(result.key, result.mesh);
+        }
+        else if (fail)
+        {
+            fail(result.key);
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+size_t MeshPipeline::pending_count() const
+{
+    const std::lock_guard lock(mutex);
+    return jobs.size() + running_count + results.size();
+}
+
+unsigned MeshPipeline::default_worker_count()
+{
+    // Leave one hardware thread to the render loop.
+    return std::max(2u, std::thread::hardware_concurrency()) - 1;
+}
+
+void MeshPipeline::work()
+{
+    while (true)
+    {
+        Job job;
+
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [&]() { return stopping || !jobs.empty(); });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            running_count++;
+        }
+
+        std::shared_ptr<const Mesh> mesh;
+        bool failed = false;
+
+        // An exception leaving the worker would terminate the process, so it fails only the job's key.
+        try
+        {
+            PROFILE_ZONE("Mesh job");
+            mesh = job.run();
+        }
+        catch (const std::exception &error)
+        {
+            spdlog::error("Mesh job for key {} failed: {}", job.key, error.what());
+            failed = true;
+        }
+        catch (...)
+        {
+            spdlog::error("Mesh job for key {} failed.", job.key);
+            failed = true;
+        }
+
+        const std::lock_guard lock(mutex);
+        running_count--;
+
+        // Results of replaced requests would only be overwritten again.
+        if (is_latest(job.key, job.version))
+        {
+            results.push_back(Result{job.key, job.version, std::move(mesh), failed});
+        }
+    }
+}
+
+bool MeshPipeline::is_latest(const uint64_t key, const uint64_t version) const
+{
+    const auto it = latest_versions.find(key);
+    return it != latest_versions.end() && it->second == version;
+}
@@ -0,0 +1,163 @@
+#include <voxel-blaze/noise.hpp>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define VOXEL_BLAZE_AVX2_NOISE
+#include <immintrin.h>
+#endif
+
+#ifdef VOXEL_BLAZE_AVX2_NOISE
+// Mirrors the classic Perlin noise of `glm::perlin` operation by operation, one lane per position. FMA is not enabled
+// so the results do not differ from the scalar version.
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+namespace
+{
+    struct Lanes
+    {
+        __m256 x, y, z;
+    };
+
+    AVX2_TARGET inline __m256 fract(const __m256 value)
+    {
+        return _mm256_sub_ps(value, _mm256_floor_ps(value));
+    }
+
+    AVX2_TARGET inline __m256 abs(const __m256 value)
+    {
+        return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+    }
+
+    AVX2_TARGET inline __m256 mod289(const __m256 value)
+    {
+        const __m256 quotient = _mm256_floor_ps(_mm256_mul_ps(value, _mm256_set1_ps(1.0f / 289.0f)));
+        return _mm256_sub_ps(value, _mm256_mul_ps(quotient, _mm256_set1_ps(289.0f)));
+    }
+
+    AVX2_TARGET inline __m256 permute(const __m256 value)
+    {
+        const __m256 scaled = _mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(34.0f)), _mm256_set1_ps(1.0f));
+        return mod289(_mm256_mul_ps(scaled, value));
+    }
+
+    AVX2_TARGET inline __m256 fade(const __m256 t)
+    {
+        const __m256 inner = _mm256_add_ps(
+            _mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f))),
+            _mm256_set1_ps(10.0f));
+        return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+    }
+
+    AVX2_TARGET inline __m256 mix(const __m256 a, const __m256 b, const __m256 t)
+    {
+        return _mm256_add_ps(_mm256_mul_ps(a, _mm256_sub_ps(_mm256_set1_ps(1.0f), t)), _mm256_mul_ps(b, t));
+    }
+
+    // Contribution of one lattice corner, `hash` selects the gradient and `offset` is the position relative to it.
+    AVX2_TARGET inline __m256 corner(const __m256 hash, const Lanes &offset)
+    {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+
+        __m256 gx = _mm256_mul_ps(hash, _mm256_set1_ps(1.0f / 7.0f));
+        __m256 gy = _mm256_sub_ps(fract(_mm256_mul_ps(_mm256_floor_ps(gx), _mm256_set1_ps(1.0f / 7.0f))), half);
+        gx = fract(gx);
+        const __m256 gz = _mm256_sub_ps(_mm256_sub_ps(half, abs(gx)), abs(gy));
+
+        const __m256 sz = _mm256_and_ps(_mm256_cmp_ps(gz, zero, _CMP_LE_OQ), one);
+        const __m256 sx = _mm256_and_ps(_mm256_cmp_ps(gx, zero, _CMP_GE_OQ), one);
+        const __m256 sy = _mm256_and_ps(_mm256_cmp_ps(gy, zero, _CMP_GE_OQ), one);
+        gx = _mm256_sub_ps(gx, _mm256_mul_ps(sz, _mm256_sub_ps(sx, half)));
+        gy = _mm256_sub_ps(gy, _mm256_mul_ps(sz, _mm256_sub_ps(sy, half)));
+
+        const __m256 length = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(gx, gx), _mm256_mul_ps(gy, gy)),
+                                            _mm256_mul_ps(gz, gz));
+        const __m256 norm = _mm256_sub_ps(_mm256_set1_ps(1.79284291400159f),
+                                          _mm256_mul_ps(_mm256_set1_ps(0.85373472095314f), length));
+
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(gx, norm), offset.x),
+                                           _mm256_mul_ps(_mm256_mul_ps(gy, norm), offset.y)),
+                             _mm256_mul_ps(_mm256_mul_ps(gz, norm), offset.z));
+    }
+
+    AVX2_TARGET inline __m256 perlin(const Lanes &position)
+    {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const Lanes floored = {_mm256_floor_ps(position.x), _mm256_floor_ps(position.y), _mm256_floor_ps(position.z)};
+        const Lanes cell0 = {mod289(floored.x), mod289(floored.y), mod289(floored.z)};
+        const Lanes cell1 = {mod289(_mm256_add_ps(floored.x, one)), mod289(_mm256_add_ps(floored.y, one)),
+                             mod289(_mm256_add_ps(floored.z, one))};
+        const Lanes fraction0 = {fract(position.x), fract(position.y), fract(position.z)};
+        const Lanes fraction1 = {_mm256_sub_ps(fraction0.x, one), _mm256_sub_ps(fraction0.y, one),
+                                 _mm256_sub_ps(fraction0.z, one)};
+
+        const __m256 hash_x0 = permute(cell0.x);
+        const __m256 hash_x1 = permute(cell1.x);
+        const __m256 hash_00 = permute(_mm256_add_ps(hash_x0, cell0.y));
+        const __m256 hash_10 = permute(_mm256_add_ps(hash_x1, cell0.y));
+        const __m256 hash_01 = permute(_mm256_add_ps(hash_x0, cell1.y));
+        const __m256 hash_11 = permute(_mm256_add_ps(hash_x1, cell1.y));
+
+        const __m256 n000 = corner(permute(_mm256_add_ps(hash_00, cell0.z)), {fraction0.x, fraction0.y, fraction0.z});
+        const __m256 n100 = corner(permute(_mm256_add_ps(hash_10, cell0.z)), {fraction1.x, fraction0.y, fraction0.z});
+        const __m256 n010 = corner(permute(_mm256_add_ps(hash_01, cell0.z)), {fraction0.x, fraction1.y, fraction0.z});
+        const __m256 n110 = corner(permute(_mm256_add_ps(hash_11, cell0.z)), {fraction1.x, fraction1.y, fraction0.z});
+        const __m256 n001 = corner(permute(_mm256_add_ps(hash_00, cell1.z)), {fraction0.x, fraction0.y, fraction1.z});
+        const __m256 n101 = corner(permute(_mm256_add_ps(hash_10, cell1.z)), {fraction1.x, fraction0.y, fraction1.z});
+        const __m256 n011 = corner(permute(_mm256_add_ps(hash_01, cell1.z)), {fraction0.x, fraction1.y, fraction1.z});
+        const __m256 n111 = corner(permute(_mm256_add_ps(hash_11, cell1.z)), {fraction1.x, fraction1.y, fraction1.z});
+
+        const __m256 fade_x = fade(fraction0.x);
+        const __m256 fade_y = fade(fraction0.y);
+        const __m256 fade_z = fade(fraction0.z);
+        const __m256 n00 = mix(n000, n001, fade_z);
+        const __m256 n10 = mix(n100, n101, fade_z);
+        const __m256 n01 = mix(n010, n011, fade_z);
+        const __m256 n11 = mix(n110, n111, fade_z);
+        const __m256 n0 = mix(n00, n01, fade_y);
+        const __m256 n1 = mix(n10, n11, fade_y);
+
+        return _mm256_mul_ps(_mm256_set1_ps(2.2f), mix(n0, n1, fade_x));
+    }
+
+    // Returns the number of values written, always a multiple of eight.
+    AVX2_TARGET unsigned perlin_row_avx2(const glm::vec3 &scale, const glm::vec3 &offset, const unsigned y,
+                                         const unsigned z, const unsigned count, float *values)
+    {
+        const __m256 lane_offsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        const __m256 position_y = _mm256_set1_ps(float(y) * scale.y + offset.y);
+        const __m256 position_z = _mm256_set1_ps(float(z) * scale.z + offset.z);
+        unsigned x = 0;
+
+        for (; x + 8 <= count; x += 8)
+        {
+            const __m256 lane_x = _mm256_add_ps(_mm256_set1_ps(float(x)), lane_offsets);
+            const __m256 position_x =
+                _mm256_add_ps(_mm256_mul_ps(lane_x, _mm256_set1_ps(scale.x)), _mm256_set1_ps(offset.x));
+            _mm256_storeu_ps(values + x, perlin({position_x, position_y, position_z}));
+        }
+
+        return x;
+    }
+
+    const bool has_avx2 = __builtin_cpu_supports("avx2");
+}
+#endif
+
+void perlin_row(const glm::vec3 &scale, const glm::vec3 &offset, const unsigned y, const unsigned z,
+                const unsigned count, float *values)
+{
+    unsigned x = 0;
+
+#ifdef VOXEL_BLAZE_AVX2_NOISE
+    if (has_avx2)
+    {
+        x = perlin_row_avx2(scale, offset, y, z, count, values);
+    }
+#endif
+
+    for (; x < count; x++)
+    {
+        values[x] = glm::perlin(glm::vec3(x, y, z) * scale + offset);
+    }
+}
@@ -0,0 +1,142 @@
+#include <voxel-blaze/parsers/mapped_file.hpp>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &path)
+{
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE)
+    {
+        file_handle = nullptr;
+        throw std::runtime_error("Unable to open file");
+    }
+
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file_handle, &file_size);
+    length = static_cast<size_t>(file_size.QuadPart);
+
+    // Empty files cannot be mapped, leave the view empty.
+    if (length == 0)
+    {
+        return;
+    }
+
+    mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr)
+    {
+        CloseHandle(file_handle);
+        throw std::runtime_error("Unable to map file");
+    }
+
+    bytes = static_cast<const uint8_t *>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (bytes == nullptr)
+    {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        throw std::runtime_error("Unable to map file");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (bytes != nullptr)
+    {
+        UnmapViewOfFile(bytes);
+    }
+
+    if (mapping_handle != nullptr)
+    {
+        CloseHandle(mapping_handle);
+    }
+
+    if (file_handle != nullptr)
+    {
+        CloseHandle(file_handle);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path)
+{
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+
+    struct stat file_stat;
+    if (fstat(descriptor, &file_stat) != 0)
+    {
+        close(descriptor);
+        throw std::runtime_error("Unable to open file");
+    }
+
+    length = static_cast<size_t>(file_stat.st_size);
+
+    // Empty files cannot be mapped, leave the view empty.
+    if (length == 0)
+    {
+        close(descriptor);
+        return;
+    }
+
+    void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+
+    if (mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Unable to map file");
+    }
+
+    // The whole file is walked front to back right after mapping.
+    madvise(mapping, length, MADV_WILLNEED);
+    bytes = static_cast<const uint8_t *>(mapping);
+}
+
+MappedFile::~MappedFile()
+{
+    if (bytes != nullptr)
+    {
+        munmap(const_cast<uint8_t *>(bytes), length);
+    }
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile &&other)
+    : bytes(other.bytes), length(other.length)
+#ifdef _WIN32
+      ,
+      file_handle(other.file_handle), mapping_handle(other.mapping_handle)
+#endif
+{
+    other.bytes = nullptr;
+    other.length = 0;
+#ifdef _WIN32
+    other.file_handle = nullptr;
+    other.mapping_handle = nullptr;
+#endif
+}
+
+const uint8_t *MappedFile::data() const
+{
+    return bytes;
+}
+
+size_t MappedFile::size() const
+{
+    return length;
+}
@@ -0,0 +1,221 @@
+#include <voxel-blaze/hash.hpp>
+#include <voxel-blaze/parsers/vbz_cache.hpp>
+#include <voxel-blaze/trace.hpp>
+
+namespace
+{
+    const char magic[4] = {'V', 'B', 'Z', '\0'};
+    const uint64_t section_alignment = 16;
+
+    uint64_t align(const uint64_t offset)
+    {
+        return (offset + section_alignment - 1) / section_alignment * section_alignment;
+    }
+}
+
+VbzCache::VbzCache(const std::string &path) : file(path)
+{
+    if (file.size() < sizeof(Header))
+    {
+        throw std::runtime_error("Invalid .vbz file format");
+    }
+
+    std::memcpy(&header, file.data(), sizeof(Header));
+
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error("Invalid .vbz file format");
+    }
+
+    if (header.version != version)
+    {
+        throw std::runtime_error("Unsupported .vbz file version");
+    }
+
+    // Validate all sections once, accessors can then hand out pointers without checks.
+    section<Voxel>(header.palette_offset, 256);
+    section<uint8_t>(header.grid_offset, (uint64_t)header.size_x * header.size_y * header.size_z);
+    section<MeshChunk>(header.chunks_offset, header.chunk_count);
+    section<Vertex>(header.vertices_offset, header.vertex_count);
+    section<unsigned>(header.indices_offset, header.index_count);
+
+    spdlog::info("Mapped VBZ cache with {} vertices, {} indices and {} chunks", header.vertex_count,
+                 header.index_count, header.chunk_count);
+}
+
+void VbzCache::write(const std::string &path, const uint64_t source_hash, const VoxelGrid &voxel_grid,
+                     const std::vector<Mesh> &chunk_meshes)
+{
+    TRACE_ZONE("Write VBZ cache");
+    const auto size = voxel_grid.get_size();
+
+    // Convert the grid to palette indices.
+    VoxelPalette palette;
+    std::vector<uint8_t> grid((size_t)size.x * size.y * size.z, 0);
+
+    for (unsigned z = 0; z < size.z; z++)
+    {
+        for (unsigned y = 0; y < size.y; y++)
+        {
+            for (unsigned x = 0; x < size.x; x++)
+            {
+                const auto voxel = voxel_grid.get_voxel(x, y, z);
+
+                if (voxel.has_value())
+                {
+                    grid[x + size.x * (y + (size_t)size.y * z)] = palette.find_or_add(*voxel);
+                }
+            }
+        }
+    }
+
+    // Concatenate chunk meshes, indices are rebased onto the shared vertex buffer.
+    std::vector<MeshChunk> chunks;
+    uint64_t vertex_count = 0;
+    uint64_t index_count = 0;
+
+    for (const auto &mesh : chunk_meshes)
+    {
+        chunks.push_back({(uint32_t)vertex_count, (uint32_t)mesh.vertices.size(), (uint32_t)index_count,
+                          (uint32_t)mesh.indices.size()});
+        vertex_count += mesh.vertices.size();
+        index_count += mesh.indices.size();
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.source_hash = source_hash;
+    header.size_x = size.x;
+    header.size_y = size.y;
+    header.size_z = size.z;
+    header.chunk_count = chunks.size();
+    header.vertex_count = vertex_count;
+    header.index_count = index_count;
+    header.palette_offset = align(sizeof(Header));
+    header.grid_offset = align(header.palette_offset + sizeof(Palette));
+    header.chunks_offset = align(header.grid_offset + grid.size());
+    header.vertices_offset = align(header.chunks_offset + chunks.size() * sizeof(MeshChunk));
+    header.indices_offset = align(header.vertices_offset + vertex_count * sizeof(Vertex));
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+
+    const auto write_section = [&file](const uint64_t offset, const void *data, const uint64_t size) {
+        // Pad up to the aligned section start.
+        static const char padding[section_alignment] = {};
+        file.write(padding, offset - (uint64_t)file.tellp());
+        file.write(static_cast<const char *>(data), size);
+    };
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    write_section(header.palette_offset, palette.get_colors().data(), sizeof(Palette));
+    write_section(header.grid_offset, grid.data(), grid.size());
+    write_section(header.chunks_offset, chunks.data(), chunks.size() * sizeof(MeshChunk));
+    write_section(header.vertices_offset, nullptr, 0);
+
+    for (const auto &mesh : chunk_meshes)
+    {
+        file.write(reinterpret_cast<const char *>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+    }
+
+    write_section(header.indices_offset, nullptr, 0);
+
+    for (size_t i = 0; i < chunk_meshes.size(); i++)
+    {
+        std::vector<unsigned> indices = chunk_meshes[i].indices;
+        for (auto &index : indices)
+        {
+            index += chunks[i].vertex_offset;
+        }
+
+        file.write(reinterpret_cast<const char *>(indices.data()), indices.size() * sizeof(unsigned));
+    }
+
+    file.close();
+
+    spdlog::info("Wrote VBZ cache with {} vertices, {} indices and {} chunks", vertex_count, index_count,
+                 chunks.size());
+}
+
+std::unique_ptr<VbzCache> VbzCache::open(const std::string &path, const uint64_t source_hash)
+{
+    TRACE_ZONE("Open VBZ cache");
+    if (!std::filesystem::exists(path))
+    {
+        return nullptr;
+    }
+
+    try
+    {
+        auto cache = std::make_unique<VbzCache>(path);
+
+        if (cache->get_source_hash() != source_hash)
+        {
+            spdlog::info("Ignoring stale VBZ cache `{}`", path);
+            return nullptr;
+        }
+
+        return cache;
+    }
+    catch (const std::runtime_error &error)
+    {
+        spdlog::warn("Ignoring VBZ cache `{}`: {}", path, error.what());
+        return nullptr;
+    }
+}
+
+uint64_t VbzCache::hash_file(const std::string &path)
+{
+    const MappedFile source(path);
+    return hash_bytes(source.data(), source.size());
+}
+
+uint64_t VbzCache::get_source_hash() const
+{
+    return header.source_hash;
+}
+
+glm::uvec3 VbzCache::get_size() const
+{
+    return glm::uvec3(header.size_x, header.size_y, header.size_z);
+}
+
+const Palette &VbzCache::get_palette() const
+{
+    return *reinterpret_cast<const Palette *>(section<Voxel>(header.palette_offset, 256));
+}
+
+std::unique_ptr<PaletteVoxelGrid> VbzCache::get_voxel_grid() const
+{
+    auto voxel_grid = std::make_unique<PaletteVoxelGrid>(header.size_x, header.size_y, header.size_z);
+    const auto *grid = section<uint8_t>(header.grid_offset, (uint64_t)header.size_x * header.size_y * header.size_z);
+    voxel_grid->set_indices(grid, get_palette());
+    return voxel_grid;
+}
+
+MeshView VbzCache::get_mesh() const
+{
+    return MeshView{section<Vertex>(header.vertices_offset, header.vertex_count), header.vertex_count,
+                    section<unsigned>(header.indices_offset, header.index_count), header.index_count};
+}
+
+std::vector<MeshChunk> VbzCache::get_chunks() const
+{
+    const auto *chunks = section<MeshChunk>(header.chunks_offset, header.chunk_count);
+    return std::vector<MeshChunk>(chunks, chunks + header.chunk_count);
+}
+
+template <typename T>
+const T *VbzCache::section(const uint64_t offset, const uint64_t count) const
+{
+    if (offset % alignof(T) != 0 || offset > file.size() || (file.size() - offset) / sizeof(T) < count)
+    {
+        throw std::runtime_error("Truncated .vbz file");
+    }
+
+    return reinterpret_cast<const T *>(file.data() + offset);
+}
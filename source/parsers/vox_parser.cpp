@@ -1,139 +1,497 @@
 #include <voxel-blaze/consts.hpp>
+#include <voxel-blaze/parallel.hpp>
 #include <voxel-blaze/parsers/vox_parser.hpp>
+#include <voxel-blaze/trace.hpp>
 
-VoxParser::VoxParser(const std::string &path)
+namespace
 {
-    std::ifstream file(path, std::ios::binary);
+    using Rotation = std::array<glm::ivec3, 3>;
 
+    // Decodes the packed `_r` byte of a transform node into matrix rows.
+    Rotation decode_rotation(const uint8_t bits)
+    {
+        const int first = bits & 0x03;
+        const int second = (bits >> 2) & 0x03;
+
+        if (first > 2 || second > 2 || first == second)
+        {
+            spdlog::warn("Ignoring invalid VOX rotation {}", bits);
+            return {glm::ivec3(1, 0, 0), glm::ivec3(0, 1, 0), glm::ivec3(0, 0, 1)};
+        }
+
+        const int third = 3 - first - second;
+        Rotation rotation = {glm::ivec3(0), glm::ivec3(0), glm::ivec3(0)};
+        rotation[0][first] = (bits & 0x10) ? -1 : 1;
+        rotation[1][second] = (bits & 0x20) ? -1 : 1;
+        rotation[2][third] = (bits & 0x40) ? -1 : 1;
+        return rotation;
+    }
+
+    glm::ivec3 multiply(const Rotation &rotation, const glm::ivec3 &vector)
+    {
+        glm::ivec3 result;
+
+        for (unsigned row = 0; row < 3; row++)
+        {
+            result[row] = rotation[row].x * vector.x + rotation[row].y * vector.y + rotation[row].z * vector.z;
+        }
+
+        return result;
+    }
+
+    Rotation multiply(const Rotation &left, const Rotation &right)
+    {
+        Rotation result;
+
+        for (unsigned row = 0; row < 3; row++)
+        {
+            for (unsigned column = 0; column < 3; column++)
+            {
+                result[row][column] = left[row][0] * right[0][column] + left[row][1] * right[1][column] +
+                                      left[row][2] * right[2][column];
+            }
+        }
+
+        return result;
+    }
+
+    // Voxel decoded into world space, before it is written into the scene grid.
+    struct SceneVoxel
+    {
+        unsigned x, y, z;
+        uint8_t i;
+    };
+}
+
+VoxParser::VoxParser(const std::string &path) : file(path)
+{
+    TRACE_ZONE("Parse VOX file");
     // Check header.
-    char header[4];
-    file.read(header, sizeof(header) / sizeof(*header));
-    if (header[0] != 'V' || header[1] != 'O' || header[2] != 'X' || header[3] != ' ')
+    if (file.size() < 8 || std::memcmp(file.data(), "VOX ", 4) != 0)
     {
-        std::cerr << "Error: Invalid .vox file format." << std::endl;
+        throw std::runtime_error("Invalid .vox file format");
     }
 
     // Check version.
-    uint32_t version;
-    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    SPDLOG_TRACE("Found VOX version {}", read_uint32(4));
 
-    const auto read_bytes = read_chunk(file) + 8;
-    spdlog::info("Read VOX file with a size of {}B", read_bytes);
-    file.close();
+    const auto read_bytes = read_chunk(8, file.size());
+    spdlog::info("Read VOX file with a size of {}B, {} models and {} scene nodes", read_bytes, models.size(),
+                 nodes.size());
 
     // Use default pallette if necessary
-    if (colors.empty())
+    if (!has_colors)
     {
-        colors.reserve(256);
-        for (uint32_t default_color : consts::vox_default_palette)
+        for (unsigned i = 0; i < 256; i++)
         {
+            const uint32_t default_color = consts::vox_default_palette[i];
             const uint8_t r = (default_color >> 24) & 0xFF;
             const uint8_t g = (default_color >> 16) & 0xFF;
             const uint8_t b = (default_color >> 8) & 0xFF;
             const uint8_t a = default_color & 0xFF;
-            colors.push_back({r, g, b, a});
+            colors[i] = {r, g, b, a};
         }
     }
 }
 
 std::unique_ptr<VoxelGrid> VoxParser::get_voxel_grid() const
 {
+    // Scenes with several models are composed in world space.
+    if (models.size() > 1)
+    {
+        return get_scene_grid();
+    }
+
     // Create voxel grid.
-    std::unique_ptr<VoxelGrid> voxel_grid = std::make_unique<ArrayVoxelGrid>(size_x, size_y, size_z);
-    
-    for (const auto voxel_entry : voxels)
+    const auto size = get_size();
+    std::unique_ptr<VoxelGrid> voxel_grid = std::make_unique<ArrayVoxelGrid>(size.x, size.y, size.z);
+    read_into(*voxel_grid);
+    return voxel_grid;
+}
+
+std::unique_ptr<PaletteVoxelGrid> VoxParser::get_palette_voxel_grid(const size_t model) const
+{
+    const auto size = get_size(model);
+    auto voxel_grid = std::make_unique<PaletteVoxelGrid>(size.x, size.y, size.z);
+    read_into(*voxel_grid, model);
+    return voxel_grid;
+}
+
+std::unique_ptr<SparseVoxelGrid> VoxParser::get_scene_grid() const
+{
+    TRACE_ZONE("Compose VOX scene");
+    const auto instances = collect_instances();
+
+    if (instances.empty())
+    {
+        spdlog::warn("VOX file does not contain any visible models");
+        return std::make_unique<SparseVoxelGrid>(0, 0, 0);
+    }
+
+    // Compute world bounds, opposite model corners stay opposite under axis permutations.
+    glm::ivec3 world_min(std::numeric_limits<int>::max());
+    glm::ivec3 world_max(std::numeric_limits<int>::min());
+    std::vector<size_t> offsets = {0};
+
+    for (const auto &instance : instances)
+    {
+        const auto &model = models[instance.model];
+        const auto first = instance.apply(glm::ivec3(0));
+        const auto last = instance.apply(glm::ivec3(model.size) - glm::ivec3(1));
+        world_min = glm::min(world_min, glm::min(first, last));
+        world_max = glm::max(world_max, glm::max(first, last));
+        offsets.push_back(offsets.back() + model.voxel_count);
+    }
+
+    // Decode and transform all models in parallel, every thread takes a contiguous range of entries.
+    std::vector<SceneVoxel> scene_voxels(offsets.back());
+    const unsigned dropped = std::numeric_limits<unsigned>::max();
+
+    parallel_for(scene_voxels.size(), [&](const size_t begin, const size_t end) {
+        PROFILE_ZONE("Transform instances");
+        size_t instance_index = std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin() - 1;
+
+        for (size_t i = begin; i < end; i++)
+        {
+            while (i >= offsets[instance_index + 1])
+            {
+                instance_index += 1;
+            }
+
+            const auto &instance = instances[instance_index];
+            const auto &model = models[instance.model];
+            const auto entry = model.voxels[i - offsets[instance_index]];
+
+            // Entries outside their model are dropped like in `set_voxels`, transformed they could land anywhere.
+            if (entry.x >= model.size.x || entry.y >= model.size.y || entry.z >= model.size.z)
+            {
+                scene_voxels[i] = {dropped, dropped, dropped, 0};
+                continue;
+            }
+
+            const auto position = instance.apply(glm::ivec3(entry.x, entry.y, entry.z)) - world_min;
+            scene_voxels[i] = {(unsigned)position.x, (unsigned)position.y, (unsigned)position.z, entry.i};
+        }
+    });
+
+    // Place voxels in scene order, later models overwrite earlier ones.
+    const auto world_size = world_max - world_min + glm::ivec3(1);
+    auto voxel_grid = std::make_unique<SparseVoxelGrid>(world_size.x, world_size.y, world_size.z);
+    voxel_grid->set_palette(get_palette());
+
     {
-        spdlog::trace("Found voxel entry {} {} {} {}", voxel_entry.x, voxel_entry.y, voxel_entry.z, voxel_entry.i);
-        const auto color_entry = colors[voxel_entry.i];
-        voxel_grid->set_voxel(voxel_entry.x, voxel_entry.y, voxel_entry.z,
-                             Voxel{color_entry.r / 255.0f, color_entry.g / 255.0f, color_entry.b / 255.0f});
+        PROFILE_ZONE("Place scene voxels");
+
+        for (const auto &voxel : scene_voxels)
+        {
+            if (voxel.x != dropped)
+            {
+                voxel_grid->set_index(voxel.x, voxel.y, voxel.z, voxel.i);
+            }
+        }
     }
 
+    spdlog::info("Placed {} model instances with {} voxels in a {}x{}x{} scene ({} chunks)", instances.size(),
+                 scene_voxels.size(), world_size.x, world_size.y, world_size.z, voxel_grid->chunk_count());
+
     return voxel_grid;
 }
 
-std::streamsize VoxParser::read_chunk(std::ifstream &file)
+void VoxParser::read_into(VoxelGrid &voxel_grid, const size_t model) const
+{
+    TRACE_ZONE("Decode VOX model");
+    if (model >= models.size())
+    {
+        spdlog::warn("VOX file does not contain model #{}", model);
+        return;
+    }
+
+    // Decode straight from the mapped entries, colors are resolved once up front.
+    voxel_grid.set_voxels(models[model].voxels, models[model].voxel_count, get_palette());
+    SPDLOG_DEBUG("Decoded {} voxel entries", models[model].voxel_count);
+}
+
+size_t VoxParser::model_count() const
+{
+    return models.size();
+}
+
+glm::uvec3 VoxParser::get_size(const size_t model) const
+{
+    return model < models.size() ? models[model].size : glm::uvec3(0);
+}
+
+Palette VoxParser::get_palette() const
+{
+    Palette palette;
+
+    for (unsigned i = 0; i < 256; i++)
+    {
+        const auto color_entry = colors[i];
+        palette[i] = Voxel{color_entry.r / 255.0f, color_entry.g / 255.0f, color_entry.b / 255.0f};
+    }
+
+    return palette;
+}
+
+glm::ivec3 VoxParser::ModelInstance::apply(const glm::ivec3 &position) const
+{
+    return multiply(rotation, position) + translation;
+}
+
+uint32_t VoxParser::read_uint32(size_t offset) const
+{
+    uint32_t value;
+    std::memcpy(&value, file.data() + offset, sizeof(value));
+    return value;
+}
+
+uint32_t VoxParser::read_uint32(size_t &offset, size_t end) const
+{
+    if (end - offset < 4)
+    {
+        throw std::runtime_error("Truncated .vox chunk data");
+    }
+
+    const auto value = read_uint32(offset);
+    offset += 4;
+    return value;
+}
+
+std::string VoxParser::read_string(size_t &offset, size_t end) const
 {
-    // Keep track of read bytes.
-    std::streampos start_byte_pos = file.tellg();
+    const uint32_t length = read_uint32(offset, end);
+
+    if (end - offset < length)
+    {
+        throw std::runtime_error("Truncated .vox chunk data");
+    }
+
+    std::string value(reinterpret_cast<const char *>(file.data() + offset), length);
+    offset += length;
+    return value;
+}
+
+VoxParser::Dictionary VoxParser::read_dictionary(size_t &offset, size_t end) const
+{
+    Dictionary dictionary;
+    const uint32_t entry_count = read_uint32(offset, end);
+
+    for (uint32_t i = 0; i < entry_count; i++)
+    {
+        auto key = read_string(offset, end);
+        dictionary[key] = read_string(offset, end);
+    }
+
+    return dictionary;
+}
 
+size_t VoxParser::read_chunk(size_t offset, size_t end)
+{
     // Read chunk metadata.
-    char chunk_id[4];
-    uint32_t chunk_data_size;
-    uint32_t chunk_children_size;
-    file.read(chunk_id, sizeof(chunk_id) / sizeof(*chunk_id));
-    file.read(reinterpret_cast<char *>(&chunk_data_size), sizeof(chunk_data_size));
-    file.read(reinterpret_cast<char *>(&chunk_children_size), sizeof(chunk_children_size));
-
-    spdlog::trace("Found chunk {}{}{}{} with data size of {}B and children size of {}B", chunk_id[0], chunk_id[1],
+    if (end - offset < 12)
+    {
+        throw std::runtime_error("Truncated .vox chunk header");
+    }
+
+    const char *chunk_id = reinterpret_cast<const char *>(file.data() + offset);
+    const uint32_t chunk_data_size = read_uint32(offset + 4);
+    const uint32_t chunk_children_size = read_uint32(offset + 8);
+    offset += 12;
+
+    SPDLOG_TRACE("Found chunk {}{}{}{} with data size of {}B and children size of {}B", chunk_id[0], chunk_id[1],
                   chunk_id[2], chunk_id[3], chunk_data_size, chunk_children_size);
 
-    if (chunk_id[0] == 'S' && chunk_id[1] == 'I' && chunk_id[2] == 'Z' && chunk_id[3] == 'E')
+    if (end - offset < (size_t)chunk_data_size + chunk_children_size)
     {
-        // Extract chunk size information.
-        file.read(reinterpret_cast<char *>(&size_x), sizeof(size_x));
-        file.read(reinterpret_cast<char *>(&size_y), sizeof(size_y));
-        file.read(reinterpret_cast<char *>(&size_z), sizeof(size_z));
+        throw std::runtime_error("Truncated .vox chunk data");
+    }
 
-        spdlog::trace("Found size {}x{}x{}", size_x, size_y, size_z);
+    if (std::memcmp(chunk_id, "SIZE", 4) == 0 && chunk_data_size >= 12)
+    {
+        // Every SIZE chunk starts a new model.
+        VoxModel model;
+        model.size = glm::uvec3(read_uint32(offset), read_uint32(offset + 4), read_uint32(offset + 8));
+        models.push_back(model);
+
+        SPDLOG_TRACE("Found size {}x{}x{}", model.size.x, model.size.y, model.size.z);
+    }
+    else if (std::memcmp(chunk_id, "XYZI", 4) == 0 && chunk_data_size >= 4 && !models.empty())
+    {
+        // Reference voxel information in place, entries are packed bytes.
+        auto &model = models.back();
+        model.voxel_count = std::min<uint32_t>(read_uint32(offset), (chunk_data_size - 4) / sizeof(IndexedVoxel));
+        model.voxels = reinterpret_cast<const IndexedVoxel *>(file.data() + offset + 4);
+
+        SPDLOG_TRACE("Found {} voxels", model.voxel_count);
     }
-    else if (chunk_id[0] == 'X' && chunk_id[1] == 'Y' && chunk_id[2] == 'Z' && chunk_id[3] == 'I')
+    else if (std::memcmp(chunk_id, "RGBA", 4) == 0 && chunk_data_size >= sizeof(colors))
+    {
+        // Extract color information.
+        std::memcpy(colors.data(), file.data() + offset, sizeof(colors));
+        has_colors = true;
+
+        SPDLOG_TRACE("Found color palette");
+    }
+    else if (std::memcmp(chunk_id, "nTRN", 4) == 0 || std::memcmp(chunk_id, "nGRP", 4) == 0 ||
+             std::memcmp(chunk_id, "nSHP", 4) == 0)
+    {
+        read_node(chunk_id, offset, offset + chunk_data_size);
+    }
+
+    // Skip data block, everything needed has been extracted.
+    offset += chunk_data_size;
+
+    const size_t children_end = offset + chunk_children_size;
+    while (offset < children_end)
+    {
+        // Recurse children tags.
+        offset = read_chunk(offset, children_end);
+    }
+
+    // Continue behind this chunk.
+    return offset;
+}
+
+void VoxParser::read_node(const char *chunk_id, size_t offset, size_t end)
+{
+    const uint32_t node_id = read_uint32(offset, end);
+    const auto attributes = read_dictionary(offset, end);
+
+    SceneNode node;
+    const auto hidden = attributes.find("_hidden");
+    node.hidden = hidden != attributes.end() && hidden->second == "1";
+
+    if (chunk_id[1] == 'T')
     {
-        // Extract voxel information.
-        uint32_t voxel_count;
-        file.read(reinterpret_cast<char *>(&voxel_count), sizeof(voxel_count));
-        voxels.reserve(voxel_count);
+        node.type = SceneNode::Type::Transform;
+        node.children.push_back(read_uint32(offset, end));
 
-        for (unsigned i = 0; i < voxel_count; i++)
+        // Skip reserved and layer identifiers.
+        read_uint32(offset, end);
+        read_uint32(offset, end);
+
+        // Only the first frame is used, animations are not supported.
+        const uint32_t frame_count = read_uint32(offset, end);
+        if (frame_count > 0)
         {
-            uint8_t voxel_x = 0;
-            uint8_t voxel_y = 0;
-            uint8_t voxel_z = 0;
-            uint8_t voxel_i = 0;
-            file.read(reinterpret_cast<char *>(&voxel_x), sizeof(voxel_x));
-            file.read(reinterpret_cast<char *>(&voxel_y), sizeof(voxel_y));
-            file.read(reinterpret_cast<char *>(&voxel_z), sizeof(voxel_z));
-            file.read(reinterpret_cast<char *>(&voxel_i), sizeof(voxel_i));
-
-            spdlog::trace("Found voxel with coordinates ({}, {}, {}, {})", voxel_x, voxel_y, voxel_z, voxel_i);
-            voxels.push_back({voxel_x, voxel_y, voxel_z, voxel_i});
+            const auto frame = read_dictionary(offset, end);
+            const auto translation = frame.find("_t");
+            const auto rotation = frame.find("_r");
+
+            if (translation != frame.end())
+            {
+                std::istringstream stream(translation->second);
+                stream >> node.translation.x >> node.translation.y >> node.translation.z;
+            }
+
+            if (rotation != frame.end())
+            {
+                node.rotation = (uint8_t)std::atoi(rotation->second.c_str());
+            }
         }
     }
-    else if (chunk_id[0] == 'R' && chunk_id[1] == 'G' && chunk_id[2] == 'B' && chunk_id[3] == 'A')
+    else if (chunk_id[1] == 'G')
     {
-        // Extract color information.
-        colors.reserve(256);
-        for (unsigned i = 0; i < 256; i++)
+        node.type = SceneNode::Type::Group;
+        const uint32_t child_count = read_uint32(offset, end);
+
+        for (uint32_t i = 0; i < child_count; i++)
         {
-            uint8_t color_r = 0;
-            uint8_t color_g = 0;
-            uint8_t color_b = 0;
-            uint8_t color_a = 0;
-            file.read(reinterpret_cast<char *>(&color_r), sizeof(color_r));
-            file.read(reinterpret_cast<char *>(&color_g), sizeof(color_g));
-            file.read(reinterpret_cast<char *>(&color_b), sizeof(color_b));
-            file.read(reinterpret_cast<char *>(&color_a), sizeof(color_a));
-
-            spdlog::trace("Found color #{} with RGBA values ({}, {}, {}, {})", i, color_r, color_g, color_b, color_a);
-            colors.push_back({color_r, color_g, color_b, color_a});
+            node.children.push_back(read_uint32(offset, end));
         }
     }
     else
     {
-        // Skip data block of unneeded tags.
-        file.seekg(chunk_data_size, std::ios::cur);
+        node.type = SceneNode::Type::Shape;
+        const uint32_t model_count = read_uint32(offset, end);
+
+        for (uint32_t i = 0; i < model_count; i++)
+        {
+            node.children.push_back(read_uint32(offset, end));
+            read_dictionary(offset, end);
+        }
+    }
+
+    SPDLOG_TRACE("Found scene node #{} with {} children", node_id, node.children.size());
+    nodes[node_id] = std::move(node);
+}
+
+std::vector<VoxParser::ModelInstance> VoxParser::collect_instances() const
+{
+    std::vector<ModelInstance> instances;
+    const ModelInstance identity = {0, decode_rotation(0x04), glm::ivec3(0)};
+
+    if (nodes.find(0) != nodes.end())
+    {
+        collect_instances(0, identity, 0, instances);
+        return instances;
     }
 
-    while (chunk_children_size > 0)
+    // Files without a scene graph place every model at the origin.
+    for (uint32_t model = 0; model < models.size(); model++)
     {
-        // Recurse children tags.
-        const auto read_rec = read_chunk(file);
-        chunk_children_size -= read_rec;
+        auto instance = identity;
+        instance.model = model;
+        instance.translation = -glm::ivec3(models[model].size / glm::uvec3(2));
+        instances.push_back(instance);
     }
 
-    // Calculate read bytes.
-    std::streampos end_pos = file.tellg();
-    std::streamsize bytes_read = end_pos - start_byte_pos;
+    return instances;
+}
+
+void VoxParser::collect_instances(const uint32_t node_id, const ModelInstance &parent, const unsigned depth,
+                                  std::vector<ModelInstance> &instances) const
+{
+    const auto it = nodes.find(node_id);
 
-    return bytes_read;
-}
\ No newline at end of file
+    // Guard against dangling references and cycles in malformed files.
+    if (it == nodes.end() || depth > 64)
+    {
+        spdlog::warn("Skipping invalid VOX scene node #{}", node_id);
+        return;
+    }
+
+    const auto &node = it->second;
+
+    if (node.hidden)
+    {
+        return;
+    }
+
+    if (node.type == SceneNode::Type::Transform)
+    {
+        ModelInstance transformed = parent;
+        transformed.rotation = multiply(parent.rotation, decode_rotation(node.rotation));
+        transformed.translation = parent.apply(node.translation);
+
+        for (const auto child : node.children)
+        {
+            collect_instances(child, transformed, depth + 1, instances);
+        }
+    }
+    else if (node.type == SceneNode::Type::Group)
+    {
+        for (const auto child : node.children)
+        {
+            collect_instances(child, parent, depth + 1, instances);
+        }
+    }
+    else
+    {
+        for (const auto model : node.children)
+        {
+            if (model >= models.size())
+            {
+                spdlog::warn("Skipping reference to missing VOX model #{}", model);
+                continue;
+            }
+
+            // Models are centered on their transform.
+            ModelInstance instance = parent;
+            instance.model = model;
+            instance.translation = parent.apply(-glm::ivec3(models[model].size / glm::uvec3(2)));
+            instances.push_back(instance);
+        }
+    }
+}
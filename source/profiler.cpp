@@ -0,0 +1,158 @@
+#include <fmt/format.h>
+#include <mutex>
+#include <voxel-blaze/profiler.hpp>
+
+namespace
+{
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ProfileBuffer>> buffers;
+        // Buffers of finished threads, handed to the next thread that records a zone.
+        std::vector<ProfileBuffer *> free_buffers;
+    };
+
+    // Buffers outlive their threads, so events of finished workers are still exported. Threads started per parallel
+    // call reuse them, which bounds the memory by the number of threads recording at the same time.
+    Registry &registry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    ProfileBuffer *acquire_buffer()
+    {
+        auto &registry = ::registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        if (!registry.free_buffers.empty())
+        {
+            const auto buffer = registry.free_buffers.back();
+            registry.free_buffers.pop_back();
+            return buffer;
+        }
+
+        registry.buffers.push_back(std::make_unique<ProfileBuffer>(registry.buffers.size()));
+        return registry.buffers.back().get();
+    }
+
+    // Returns the buffer of its thread to the registry when the thread exits.
+    struct BufferLease
+    {
+        ProfileBuffer *const buffer = acquire_buffer();
+
+        ~BufferLease()
+        {
+            auto &registry = ::registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.free_buffers.push_back(buffer);
+        }
+    };
+}
+
+std::atomic<bool> Profiler::enabled{false};
+
+ProfileBuffer::ProfileBuffer(const uint32_t thread_id)
+    : thread_id(thread_id), events(std::make_unique<ProfileEvent[]>(capacity))
+{
+}
+
+std::vector<ProfileEvent> ProfileBuffer::collect() const
+{
+    const auto count = write_index.load(std::memory_order_acquire);
+    const auto first = count > capacity ? count - capacity : 0;
+
+    std::vector<ProfileEvent> collected;
+    collected.reserve(count - first);
+
+    for (auto i = first; i < count; i++)
+    {
+        collected.push_back(events[i & (capacity - 1)]);
+    }
+
+    return collected;
+}
+
+void ProfileBuffer::clear()
+{
+    write_index.store(0, std::memory_order_release);
+}
+
+void Profiler::set_enabled(const bool enabled)
+{
+    Profiler::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::clear()
+{
+    auto &registry = ::registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for (auto &buffer : registry.buffers)
+    {
+        buffer->clear();
+    }
+}
+
+ProfileBuffer &Profiler::thread_buffer()
+{
+    thread_local BufferLease lease;
+    return *lease.buffer;
+}
+
+void Profiler::write_chrome_trace(const std::string &path)
+{
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Unable to open file");
+    }
+
+    std::vector<std::pair<uint32_t, std::vector<ProfileEvent>>> threads;
+    uint64_t origin_ns = std::numeric_limits<uint64_t>::max();
+    size_t event_count = 0;
+
+    {
+        auto &registry = ::registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        for (const auto &buffer : registry.buffers)
+        {
+            threads.push_back({buffer->thread_id, buffer->collect()});
+
+            for (const auto &event : threads.back().second)
+            {
+                origin_ns = std::min(origin_ns, event.start_ns);
+            }
+
+            event_count += threads.back().second.size();
+        }
+    }
+
+    // Trace event format, complete events with microsecond timestamps relative to the first zone.
+    fmt::memory_buffer buffer;
+    auto out = fmt::appender(buffer);
+    fmt::format_to(out, "{{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    bool first = true;
+
+    for (const auto &[thread_id, events] : threads)
+    {
+        fmt::format_to(out, "{}\n{{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": {}, "
+                            "\"args\": {{\"name\": \"{}\"}}}}",
+                       first ? "" : ",", thread_id, fmt::format("Thread {}", thread_id));
+        first = false;
+
+        for (const auto &event : events)
+        {
+            fmt::format_to(out, ",\n{{\"name\": \"{}\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, \"ts\": {:.3f}, "
+                                "\"dur\": {:.3f}}}",
+                           event.name, thread_id, (event.start_ns - origin_ns) / 1000.0,
+                           (event.end_ns - event.start_ns) / 1000.0);
+        }
+    }
+
+    fmt::format_to(out, "\n]}}\n");
+    file.write(buffer.data(), buffer.size());
+
+    spdlog::info("Wrote {} profiling zones of {} threads to `{}`", event_count, threads.size(), path);
+}
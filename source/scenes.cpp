@@ -0,0 +1,72 @@
+#include <voxel-blaze/parsers/vox_parser.hpp>
+#include <voxel-blaze/scenes.hpp>
+
+namespace
+{
+    const Voxel white = Voxel{1.0f, 1.0f, 1.0f};
+
+    const std::vector<Voxel> noise_colors = {
+        Voxel{0.90f, 0.30f, 0.25f}, Voxel{0.95f, 0.65f, 0.20f}, Voxel{0.35f, 0.75f, 0.35f},
+        Voxel{0.25f, 0.55f, 0.90f}, Voxel{0.60f, 0.35f, 0.80f}, Voxel{0.85f, 0.85f, 0.85f},
+    };
+
+    // Grass, dirt and stone from the surface downwards.
+    const std::vector<Voxel> terrain_layers = {
+        Voxel{0.35f, 0.70f, 0.25f}, Voxel{0.50f, 0.35f, 0.20f}, Voxel{0.50f, 0.35f, 0.20f},
+        Voxel{0.50f, 0.35f, 0.20f}, Voxel{0.45f, 0.45f, 0.45f},
+    };
+}
+
+glm::uvec3 Scene::get_size(const unsigned size) const
+{
+    return is_file() ? VoxParser(path).get_size() : glm::uvec3(size);
+}
+
+SceneLibrary::SceneLibrary(const uint64_t seed)
+{
+    scenes = {
+        {"cuboid", "", [](VoxelGrid &grid) { grid.fill_cuboid(white); }},
+        {"ellipsoid", "", [](VoxelGrid &grid) { grid.fill_ellipsoid(white); }},
+        {"noise", "", [seed](VoxelGrid &grid) { grid.fill_perlin_noise(white, 0.05f, seed); }},
+        {"colored-noise", "", [seed](VoxelGrid &grid) { grid.fill_colored_noise(noise_colors, 0.05f, seed); }},
+        {"checkerboard", "", [](VoxelGrid &grid) { grid.fill_checkerboard(white); }},
+        {"random-10", "", [seed](VoxelGrid &grid) { grid.fill_random(white, 0.1f, seed); }},
+        {"random-50", "", [seed](VoxelGrid &grid) { grid.fill_random(white, 0.5f, seed); }},
+        {"terrain", "", [seed](VoxelGrid &grid) { grid.fill_terrain(terrain_layers, 0.02f, seed); }},
+        {"shell", "", [](VoxelGrid &grid) { grid.fill_shell(white, 2); }},
+        {"walls", "", [](VoxelGrid &grid) { grid.fill_walls(white, 4); }},
+    };
+
+    for (const auto &[name, path] : vox_files())
+    {
+        scenes.push_back({name, path, [path = path](VoxelGrid &grid) {
+                              VoxParser parser(path);
+                              parser.read_into(grid);
+                          }});
+    }
+}
+
+const std::vector<Scene> &SceneLibrary::get_scenes() const
+{
+    return scenes;
+}
+
+const Scene &SceneLibrary::get_scene(const std::string &name) const
+{
+    const auto it = std::find_if(scenes.begin(), scenes.end(), [&name](const Scene &scene) { return scene.name == name; });
+
+    if (it == scenes.end())
+    {
+        throw std::runtime_error(fmt::format("Unknown scene `{}`", name));
+    }
+
+    return *it;
+}
+
+const std::vector<std::pair<std::string, std::string>> &SceneLibrary::vox_files()
+{
+    // Paths are relative to the project directory.
+    static const std::vector<std::pair<std::string, std::string>> files = {{"teapot", "resources/teapot.vox"},
+                                                                            {"monu", "resources/monu.vox"}};
+    return files;
+}
@@ -1,13 +1,47 @@
 #include <voxel-blaze/voxels/array_voxel_grid.hpp>
 
-ArrayVoxelGrid::ArrayVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z)
-    : VoxelGrid(size_x, size_y, size_z), voxels(size_x * size_y * size_z, std::nullopt)
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    unsigned block_count(const unsigned size, const ArrayVoxelGrid::Layout layout)
+    {
+        if (layout == ArrayVoxelGrid::Layout::Linear)
+        {
+            return size;
+        }
+
+        return (size + ArrayVoxelGrid::tile_size - 1) / ArrayVoxelGrid::tile_size;
+    }
+
+    // Interleaves the low two bits of the coordinates as x0 y0 z0 x1 y1 z1. Builds targeting BMI2 deposit the bits
+    // directly, a runtime dispatch would cost more than the shifts it saves.
+    inline unsigned interleave_tile(const unsigned x, const unsigned y, const unsigned z)
+    {
+#ifdef __BMI2__
+        return _pdep_u32(x, 0b001001) | _pdep_u32(y, 0b010010) | _pdep_u32(z, 0b100100);
+#else
+        const auto spread = [](const unsigned value) { return (value & 1) | ((value & 2) << 2); };
+        return spread(x & 3) | (spread(y & 3) << 1) | (spread(z & 3) << 2);
+#endif
+    }
+}
+
+ArrayVoxelGrid::ArrayVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z,
+                               const Layout layout)
+    : VoxelGrid(size_x, size_y, size_z), layout(layout), blocks_x(block_count(size_x, layout)),
+      blocks_y(block_count(size_y, layout)),
+      voxels(size_t(blocks_x) * blocks_y * block_count(size_z, layout) *
+                 (layout == Layout::Tiled ? tile_size * tile_size * tile_size : 1),
+             std::nullopt)
 {
 }
 
 std::optional<Voxel> ArrayVoxelGrid::get_voxel(const unsigned x, const unsigned y, const unsigned z) const
 {
-    if (x > size_x || y > size_y || z > size_z)
+    if (x >= size_x || y >= size_y || z >= size_z)
     {
         return std::nullopt;
     }
@@ -18,10 +52,126 @@ std::optional<Voxel> ArrayVoxelGrid::get_voxel(const unsigned x, const unsigned
 void ArrayVoxelGrid::set_voxel(const unsigned x, const unsigned y, const unsigned z, const std::optional<Voxel> &voxel)
 {
     voxels[calculate_index(x, y, z)] = voxel;
-    spdlog::trace("Placed voxel at ({}, {}, {}).", x, y, z);
+    SPDLOG_TRACE("Placed voxel at ({}, {}, {}).", x, y, z);
+}
+
+void ArrayVoxelGrid::set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette)
+{
+    // Write directly into storage, skipping the per voxel virtual call and trace.
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto entry = entries[i];
+
+        if (entry.x < size_x && entry.y < size_y && entry.z < size_z)
+        {
+            voxels[calculate_index(entry.x, entry.y, entry.z)] = palette[entry.i];
+        }
+    }
+
+    SPDLOG_TRACE("Placed {} voxels in bulk.", count);
 }
 
-unsigned ArrayVoxelGrid::calculate_index(const unsigned x, const unsigned y, const unsigned z) const
+void ArrayVoxelGrid::set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors)
 {
-    return x + size_x * (y + size_y * z);
+    if (layout == Layout::Linear)
+    {
+        for (size_t i = 0; i < voxels.size(); i++)
+        {
+            if (indices[i] != 0)
+            {
+                voxels[i] = colors[indices[i] - 1];
+            }
+        }
+    }
+    else
+    {
+        for (unsigned z = 0; z < size_z; z++)
+        {
+            for (unsigned y = 0; y < size_y; y++)
+            {
+                const uint8_t *row = indices + size_t(size_x) * (y + size_t(size_y) * z);
+
+                for (unsigned x = 0; x < size_x; x++)
+                {
+                    if (row[x] != 0)
+                    {
+                        voxels[calculate_index(x, y, z)] = colors[row[x] - 1];
+                    }
+                }
+            }
+        }
+    }
+
+    SPDLOG_TRACE("Placed voxels of {} indices in bulk.", voxels.size());
+}
+
+void ArrayVoxelGrid::fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y, const unsigned z,
+                                   const std::optional<Voxel> &voxel)
+{
+    if (y >= size_y || z >= size_z || begin_x >= std::min(end_x, size_x))
+    {
+        return;
+    }
+
+    if (layout == Layout::Linear)
+    {
+        const auto row = voxels.begin() + calculate_index(0, y, z);
+        std::fill(row + begin_x, row + std::min(end_x, size_x), voxel);
+        return;
+    }
+
+    for (unsigned x = begin_x; x < std::min(end_x, size_x); x++)
+    {
+        voxels[calculate_index(x, y, z)] = voxel;
+    }
+}
+
+void ArrayVoxelGrid::get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const
+{
+    if (layout == Layout::Tiled)
+    {
+        std::fill(words, words + (size_x + 63) / 64, 0);
+
+        for (unsigned x = 0; x < size_x; x++)
+        {
+            words[x / 64] |= uint64_t(voxels[calculate_index(x, y, z)].has_value()) << (x % 64);
+        }
+
+        return;
+    }
+
+    const auto row = voxels.begin() + calculate_index(0, y, z);
+
+    for (unsigned word = 0; word * 64 < size_x; word++)
+    {
+        uint64_t bits = 0;
+
+        for (unsigned bit = 0; bit < 64 && word * 64 + bit < size_x; bit++)
+        {
+            bits |= uint64_t(row[word * 64 + bit].has_value()) << bit;
+        }
+
+        words[word] = bits;
+    }
+}
+
+glm::uvec3 ArrayVoxelGrid::get_tile_size() const
+{
+    return layout == Layout::Tiled ? glm::uvec3(tile_size) : VoxelGrid::get_tile_size();
+}
+
+ArrayVoxelGrid::Layout ArrayVoxelGrid::get_layout() const
+{
+    return layout;
+}
+
+size_t ArrayVoxelGrid::calculate_index(const unsigned x, const unsigned y, const unsigned z) const
+{
+    if (layout == Layout::Linear)
+    {
+        return x + size_t(size_x) * (y + size_t(size_y) * z);
+    }
+
+    const size_t block = x / tile_size + size_t(blocks_x) * (y / tile_size + size_t(blocks_y) * (z / tile_size));
+    return block * (tile_size * tile_size * tile_size) + interleave_tile(x & 3, y & 3, z & 3);
 }
\ No newline at end of file
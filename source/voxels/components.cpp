@@ -0,0 +1,285 @@
+#include <voxel-blaze/parallel.hpp>
+#include <voxel-blaze/trace.hpp>
+#include <voxel-blaze/voxels/components.hpp>
+
+namespace
+{
+    // Returns the first bit at or after `from` that is set in `words`, or inverted in `words` when `set` is false.
+    inline unsigned find_bit(const uint64_t *words, const size_t word_count, const unsigned from, const bool set)
+    {
+        size_t word = from / 64;
+        if (word >= word_count)
+        {
+            return from;
+        }
+
+        uint64_t bits = (set ? words[word] : ~words[word]) & (~uint64_t(0) << (from % 64));
+
+        while (bits == 0)
+        {
+            word += 1;
+            if (word == word_count)
+            {
+                return word * 64;
+            }
+
+            bits = set ? words[word] : ~words[word];
+        }
+
+        return word * 64 + __builtin_ctzll(bits);
+    }
+
+    // Path halving, roots are always the smallest run of their set.
+    inline uint32_t find_root(std::vector<uint32_t> &parents, uint32_t run)
+    {
+        while (parents[run] != run)
+        {
+            parents[run] = parents[parents[run]];
+            run = parents[run];
+        }
+
+        return run;
+    }
+
+    inline void merge(std::vector<uint32_t> &parents, const uint32_t a, const uint32_t b)
+    {
+        const auto root_a = find_root(parents, a);
+        const auto root_b = find_root(parents, b);
+
+        if (root_a < root_b)
+        {
+            parents[root_b] = root_a;
+        }
+        else if (root_b < root_a)
+        {
+            parents[root_a] = root_b;
+        }
+    }
+}
+
+ComponentLabeling::ComponentLabeling(const VoxelGrid &grid, const Connectivity connectivity)
+    : size(grid.get_size()), row_offsets(size_t(size.y) * size.z + 1, 0)
+{
+    TRACE_ZONE("Label components");
+    const size_t word_count = (size.x + 63) / 64;
+    std::vector<std::vector<Run>> slice_runs(size.z);
+
+    parallel_for(size.z, [&](const size_t begin, const size_t end) {
+        PROFILE_ZONE("Find runs");
+        std::vector<uint64_t> words(word_count);
+
+        for (unsigned z = begin; z < end; z++)
+        {
+            for (unsigned y = 0; y < size.y; y++)
+            {
+                grid.get_row_occupancy(y, z, words.data());
+                const size_t row_begin = slice_runs[z].size();
+                unsigned x = find_bit(words.data(), word_count, 0, true);
+
+                while (x < size.x)
+                {
+                    const unsigned run_end = std::min(find_bit(words.data(), word_count, x, false), size.x);
+                    slice_runs[z].push_back({x, run_end, 0});
+                    x = find_bit(words.data(), word_count, run_end, true);
+                }
+
+                row_offsets[size_t(z) * size.y + y + 1] = slice_runs[z].size() - row_begin;
+            }
+        }
+    });
+
+    for (size_t row = 0; row + 1 < row_offsets.size(); row++)
+    {
+        row_offsets[row + 1] += row_offsets[row];
+    }
+
+    if (row_offsets.back() > std::numeric_limits<uint32_t>::max())
+    {
+        throw std::runtime_error("Too many runs to label");
+    }
+
+    runs.resize(row_offsets.back());
+    std::vector<uint32_t> parents(runs.size());
+    std::vector<char> block_begins(size.z, false);
+
+    // Diagonal neighbours touch when the runs are up to one voxel apart along x.
+    const unsigned reach = connectivity == Connectivity::Full ? 1 : 0;
+
+    const auto merge_rows = [&](const size_t row_a, const size_t row_b) {
+        size_t a = row_offsets[row_a];
+        size_t b = row_offsets[row_b];
+
+        while (a < row_offsets[row_a + 1] && b < row_offsets[row_b + 1])
+        {
+            if (runs[a].begin < runs[b].end + reach && runs[b].begin < runs[a].end + reach)
+            {
+                merge(parents, a, b);
+            }
+
+            if (runs[a].end < runs[b].end)
+            {
+                a++;
+            }
+            else
+            {
+                b++;
+            }
+        }
+    };
+
+    // Merges the row with the rows before it in scan order, the previous slice only when `previous_slice` is set.
+    const auto merge_neighbours = [&](const unsigned y, const unsigned z, const bool previous_slice) {
+        const size_t row = size_t(z) * size.y + y;
+
+        if (y > 0)
+        {
+            merge_rows(row, row - 1);
+        }
+
+        if (!previous_slice)
+        {
+            return;
+        }
+
+        merge_rows(row, row - size.y);
+
+        if (connectivity == Connectivity::Full)
+        {
+            if (y > 0)
+            {
+                merge_rows(row, row - size.y - 1);
+            }
+
+            if (y + 1 < size.y)
+            {
+                merge_rows(row, row - size.y + 1);
+            }
+        }
+    };
+
+    // Every block only links runs of its own slices, which form a contiguous range of `parents`.
+    parallel_for(size.z, [&](const size_t begin, const size_t end) {
+        PROFILE_ZONE("Merge runs");
+        block_begins[begin] = begin > 0;
+
+        for (unsigned z = begin; z < end; z++)
+        {
+            std::copy(slice_runs[z].begin(), slice_runs[z].end(), runs.begin() + row_offsets[size_t(z) * size.y]);
+            std::vector<Run>().swap(slice_runs[z]);
+
+            const uint32_t first = row_offsets[size_t(z) * size.y];
+            const uint32_t last = row_offsets[size_t(z + 1) * size.y];
+            for (uint32_t run = first; run < last; run++)
+            {
+                parents[run] = run;
+            }
+
+            for (unsigned y = 0; y < size.y; y++)
+            {
+                merge_neighbours(y, z, z > begin);
+            }
+        }
+    });
+
+    for (unsigned z = 1; z < size.z; z++)
+    {
+        if (block_begins[z])
+        {
+            for (unsigned y = 0; y < size.y; y++)
+            {
+                merge_neighbours(y, z, true);
+            }
+        }
+    }
+
+    // Roots precede the other runs of their set, so their label is known by the time a member is reached.
+    for (unsigned z = 0; z < size.z; z++)
+    {
+        for (unsigned y = 0; y < size.y; y++)
+        {
+            const size_t row = size_t(z) * size.y + y;
+
+            for (size_t run = row_offsets[row]; run < row_offsets[row + 1]; run++)
+            {
+                const auto root = find_root(parents, run);
+                if (root == run)
+                {
+                    runs[run].label = components.size();
+                    components.emplace_back();
+                }
+                else
+                {
+                    runs[run].label = runs[root].label;
+                }
+
+                auto &component = components[runs[run].label];
+                component.begin = glm::min(component.begin, glm::uvec3(runs[run].begin, y, z));
+                component.end = glm::max(component.end, glm::uvec3(runs[run].end, y + 1, z + 1));
+                component.voxel_count += runs[run].end - runs[run].begin;
+            }
+        }
+    }
+
+    SPDLOG_DEBUG("Labelled {} components in {} runs.", components.size(), runs.size());
+}
+
+const std::vector<Component> &ComponentLabeling::get_components() const
+{
+    return components;
+}
+
+size_t ComponentLabeling::run_count() const
+{
+    return runs.size();
+}
+
+std::optional<unsigned> ComponentLabeling::get_label(const unsigned x, const unsigned y, const unsigned z) const
+{
+    if (x >= size.x || y >= size.y || z >= size.z)
+    {
+        return std::nullopt;
+    }
+
+    const size_t row = size_t(z) * size.y + y;
+    const auto row_end = runs.begin() + row_offsets[row + 1];
+    const auto run = std::upper_bound(runs.begin() + row_offsets[row], row_end, x,
+                                      [](const unsigned x, const Run &run) { return x < run.end; });
+
+    if (run == row_end || run->begin > x)
+    {
+        return std::nullopt;
+    }
+
+    return run->label;
+}
+
+std::unique_ptr<ArrayVoxelGrid> ComponentLabeling::extract(const VoxelGrid &grid, const unsigned label) const
+{
+    const auto &component = components.at(label);
+    const glm::uvec3 extent = component.end - component.begin;
+    auto result = std::make_unique<ArrayVoxelGrid>(extent.x, extent.y, extent.z);
+
+    for (unsigned z = component.begin.z; z < component.end.z; z++)
+    {
+        for (unsigned y = component.begin.y; y < component.end.y; y++)
+        {
+            const size_t row = size_t(z) * size.y + y;
+
+            for (size_t run = row_offsets[row]; run < row_offsets[row + 1]; run++)
+            {
+                if (runs[run].label != label)
+                {
+                    continue;
+                }
+
+                for (unsigned x = runs[run].begin; x < runs[run].end; x++)
+                {
+                    result->set_voxel(x - component.begin.x, y - component.begin.y, z - component.begin.z,
+                                      grid.get_voxel(x, y, z));
+                }
+            }
+        }
+    }
+
+    return result;
+}
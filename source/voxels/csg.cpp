@@ -0,0 +1,177 @@
+#include <voxel-blaze/parallel.hpp>
+#include <voxel-blaze/trace.hpp>
+#include <voxel-blaze/voxels/csg.hpp>
+
+namespace
+{
+    // Reads 64 bits of a row starting at `bit`, bits outside of the row read as zero.
+    inline uint64_t read_bits(const std::vector<uint64_t> &words, const long bit)
+    {
+        const long word = bit >= 0 ? bit / 64 : -((-bit + 63) / 64);
+        const unsigned shift = bit - word * 64;
+        const long count = words.size();
+        const uint64_t low = word >= 0 && word < count ? words[word] : 0;
+        const uint64_t high = word + 1 >= 0 && word + 1 < count ? words[word + 1] : 0;
+        return shift == 0 ? low : (low >> shift) | (high << (64 - shift));
+    }
+
+    inline bool test_bit(const uint64_t *words, const unsigned bit)
+    {
+        return (words[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    // Calls `function(begin, end)` for every run of set bits, skipping empty and full words at once.
+    template <typename Function>
+    void for_each_run(const uint64_t *words, const unsigned bit_count, Function function)
+    {
+        unsigned x = 0;
+
+        while (x < bit_count)
+        {
+            if ((words[x / 64] >> (x % 64)) == 0)
+            {
+                x = (x / 64 + 1) * 64;
+                continue;
+            }
+
+            if (!test_bit(words, x))
+            {
+                x++;
+                continue;
+            }
+
+            const unsigned begin = x;
+
+            while (x < bit_count && test_bit(words, x))
+            {
+                x += x % 64 == 0 && words[x / 64] == ~uint64_t(0) ? 64 : 1;
+            }
+
+            function(begin, std::min(x, bit_count));
+        }
+    }
+}
+
+DirtyRegion apply_csg(VoxelGrid &target, const VoxelGrid &source, const glm::ivec3 &offset,
+                      const CsgOperation operation)
+{
+    TRACE_ZONE("Apply CSG");
+    const glm::uvec3 size = target.get_size();
+    const glm::uvec3 source_size = source.get_size();
+    const size_t word_count = (size.x + 63) / 64;
+    const size_t source_word_count = (source_size.x + 63) / 64;
+    const uint64_t last_word_mask = size.x % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (size.x % 64)) - 1;
+
+    // Voxels to write from the source and voxels to clear, one bitmask row per target row.
+    std::vector<uint64_t> writes(size_t(size.y) * size.z * word_count, 0);
+    std::vector<uint64_t> clears(size_t(size.y) * size.z * word_count, 0);
+
+    parallel_for(size.z, [&](const size_t begin, const size_t end) {
+        PROFILE_ZONE("Combine occupancy");
+        std::vector<uint64_t> target_row(word_count);
+        std::vector<uint64_t> source_row(source_word_count);
+
+        for (unsigned z = begin; z < end; z++)
+        {
+            for (unsigned y = 0; y < size.y; y++)
+            {
+                const long source_y = long(y) - offset.y;
+                const long source_z = long(z) - offset.z;
+                const bool source_present =
+                    source_y >= 0 && source_y < source_size.y && source_z >= 0 && source_z < source_size.z;
+
+                // Without a source row only intersections change anything.
+                if (!source_present && operation != CsgOperation::Intersection)
+                {
+                    continue;
+                }
+
+                std::fill(source_row.begin(), source_row.end(), 0);
+                if (source_present)
+                {
+                    source.get_row_occupancy(source_y, source_z, source_row.data());
+                }
+
+                if (operation != CsgOperation::Union)
+                {
+                    target.get_row_occupancy(y, z, target_row.data());
+                }
+
+                const size_t row = (size_t(z) * size.y + y) * word_count;
+
+                for (size_t word = 0; word < word_count; word++)
+                {
+                    const uint64_t mask = word + 1 == word_count ? last_word_mask : ~uint64_t(0);
+                    const uint64_t covered = read_bits(source_row, long(word) * 64 - offset.x) & mask;
+
+                    switch (operation)
+                    {
+                    case CsgOperation::Union:
+                        writes[row + word] = covered;
+                        break;
+                    case CsgOperation::Intersection:
+                        clears[row + word] = target_row[word] & ~covered & mask;
+                        break;
+                    case CsgOperation::Subtraction:
+                        clears[row + word] = target_row[word] & covered;
+                        break;
+                    case CsgOperation::MaskedCopy:
+                        writes[row + word] = target_row[word] & covered;
+                        break;
+                    }
+                }
+            }
+        }
+    });
+
+    // Storage backends are not safe to write from several threads, so changes are applied here as spans.
+    DirtyRegion region;
+    const auto mark = [&](const unsigned begin, const unsigned end, const unsigned y, const unsigned z) {
+        region.begin = glm::min(region.begin, glm::uvec3(begin, y, z));
+        region.end = glm::max(region.end, glm::uvec3(end, y + 1, z + 1));
+        region.voxel_count += end - begin;
+    };
+
+    for (unsigned z = 0; z < size.z; z++)
+    {
+        for (unsigned y = 0; y < size.y; y++)
+        {
+            const size_t row = (size_t(z) * size.y + y) * word_count;
+
+            for_each_run(clears.data() + row, size.x, [&](const unsigned begin, const unsigned end) {
+                target.fill_row_span(begin, end, y, z, std::nullopt);
+                mark(begin, end, y, z);
+            });
+
+            for_each_run(writes.data() + row, size.x, [&](const unsigned begin, const unsigned end) {
+                // Runs of equal source colors are written as one span.
+                unsigned span_begin = begin;
+                auto span_voxel = source.get_voxel(begin - offset.x, y - offset.y, z - offset.z);
+
+                for (unsigned x = begin + 1; x <= end; x++)
+                {
+                    const auto voxel =
+                        x < end ? source.get_voxel(x - offset.x, y - offset.y, z - offset.z) : std::nullopt;
+
+                    if (x == end || !(voxel == span_voxel))
+                    {
+                        target.fill_row_span(span_begin, x, y, z, span_voxel);
+                        span_begin = x;
+                        span_voxel = voxel;
+                    }
+                }
+
+                mark(begin, end, y, z);
+            });
+        }
+    }
+
+    if (region.empty())
+    {
+        region.begin = glm::uvec3(0);
+    }
+
+    SPDLOG_DEBUG("CSG operation changed {} voxels.", region.voxel_count);
+
+    return region;
+}
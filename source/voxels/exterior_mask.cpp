@@ -0,0 +1,176 @@
+#include <voxel-blaze/parallel.hpp>
+#include <voxel-blaze/trace.hpp>
+#include <voxel-blaze/voxels/exterior_mask.hpp>
+
+namespace
+{
+    // Spreads `seeds` towards higher bits through runs of set bits in `mask`, doubling the distance every step.
+    inline uint64_t fill_up(uint64_t seeds, uint64_t mask)
+    {
+        seeds &= mask;
+        seeds |= mask & (seeds << 1);
+        mask &= mask << 1;
+        seeds |= mask & (seeds << 2);
+        mask &= mask << 2;
+        seeds |= mask & (seeds << 4);
+        mask &= mask << 4;
+        seeds |= mask & (seeds << 8);
+        mask &= mask << 8;
+        seeds |= mask & (seeds << 16);
+        mask &= mask << 16;
+        seeds |= mask & (seeds << 32);
+        return seeds;
+    }
+
+    inline uint64_t fill_down(uint64_t seeds, uint64_t mask)
+    {
+        seeds &= mask;
+        seeds |= mask & (seeds >> 1);
+        mask &= mask >> 1;
+        seeds |= mask & (seeds >> 2);
+        mask &= mask >> 2;
+        seeds |= mask & (seeds >> 4);
+        mask &= mask >> 4;
+        seeds |= mask & (seeds >> 8);
+        mask &= mask >> 8;
+        seeds |= mask & (seeds >> 16);
+        mask &= mask >> 16;
+        seeds |= mask & (seeds >> 32);
+        return seeds;
+    }
+}
+
+ExteriorMask::ExteriorMask(const VoxelGrid &grid)
+    : size(grid.get_size()), word_count((size.x + 63) / 64), air(size_t(size.y) * size.z * word_count),
+      rows(size_t(size.y) * size.z * word_count)
+{
+    TRACE_ZONE("Find exterior air");
+    const uint64_t last_word_mask = size.x % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (size.x % 64)) - 1;
+
+    parallel_for(size.z, [&](const size_t begin, const size_t end) {
+        for (unsigned z = begin; z < end; z++)
+        {
+            for (unsigned y = 0; y < size.y; y++)
+            {
+                uint64_t *row = air.data() + (size_t(z) * size.y + y) * word_count;
+                grid.get_row_occupancy(y, z, row);
+
+                for (size_t word = 0; word < word_count; word++)
+                {
+                    row[word] = ~row[word] & (word + 1 == word_count ? last_word_mask : ~uint64_t(0));
+                    rows[row - air.data() + word].store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    });
+
+    // Every row is filled along x from its own and its neighbours' exterior bits. Sweeps alternate direction so air
+    // pockets connected through long paths converge in few sweeps, until a sweep changes nothing.
+    unsigned sweeps = 0;
+    std::atomic<bool> changed = true;
+
+    while (changed)
+    {
+        changed = false;
+        const bool forward = sweeps % 2 == 0;
+        sweeps += 1;
+
+        parallel_for(size.z, [&](const size_t begin, const size_t end) {
+            PROFILE_ZONE("Sweep exterior");
+            std::vector<uint64_t> seeds(word_count);
+            bool block_changed = false;
+
+            for (size_t i = 0; i < end - begin; i++)
+            {
+                const unsigned z = forward ? begin + i : end - 1 - i;
+
+                for (unsigned j = 0; j < size.y; j++)
+                {
+                    block_changed |= update_row(forward ? j : size.y - 1 - j, z, seeds.data());
+                }
+            }
+
+            if (block_changed)
+            {
+                changed = true;
+            }
+        });
+    }
+
+    SPDLOG_DEBUG("Found {} exterior air voxels in {} sweeps", exterior_count(), sweeps);
+}
+
+size_t ExteriorMask::exterior_count() const
+{
+    size_t count = 0;
+
+    for (const auto &word : rows)
+    {
+        for (uint64_t bits = word.load(std::memory_order_relaxed); bits != 0; bits &= bits - 1)
+        {
+            count += 1;
+        }
+    }
+
+    return count;
+}
+
+bool ExteriorMask::update_row(const unsigned y, const unsigned z, uint64_t *seeds)
+{
+    const size_t row = (size_t(z) * size.y + y) * word_count;
+    const bool boundary = y == 0 || z == 0 || y + 1 == size.y || z + 1 == size.z;
+    const auto neighbour = [&](const long offset, const size_t word) {
+        return rows[row + offset + word].load(std::memory_order_relaxed);
+    };
+
+    // Seeds are the air bits next to exterior air in y and z, or all air bits on the boundary of the grid.
+    for (size_t word = 0; word < word_count; word++)
+    {
+        uint64_t seed = rows[row + word].load(std::memory_order_relaxed);
+
+        if (boundary)
+        {
+            seed = ~uint64_t(0);
+        }
+        else
+        {
+            const long row_y = word_count;
+            const long row_z = long(word_count) * size.y;
+            seed |= neighbour(-row_y, word) | neighbour(row_y, word) | neighbour(-row_z, word) | neighbour(row_z, word);
+        }
+
+        seeds[word] = seed & air[row + word];
+    }
+
+    // Both ends of the row touch the outside.
+    seeds[0] |= air[row] & 1;
+    seeds[word_count - 1] |= air[row + word_count - 1] & (uint64_t(1) << ((size.x - 1) % 64));
+
+    // Fill along x in both directions, carrying into the next word where a run of air crosses the word boundary.
+    uint64_t carry = 0;
+    for (size_t word = 0; word < word_count; word++)
+    {
+        seeds[word] = fill_up(seeds[word] | (carry & air[row + word]), air[row + word]);
+        carry = seeds[word] >> 63;
+    }
+
+    carry = 0;
+    for (size_t word = word_count; word-- > 0;)
+    {
+        seeds[word] = fill_down(seeds[word] | ((carry << 63) & air[row + word]), air[row + word]);
+        carry = seeds[word] & 1;
+    }
+
+    bool changed = false;
+
+    for (size_t word = 0; word < word_count; word++)
+    {
+        if (seeds[word] != rows[row + word].load(std::memory_order_relaxed))
+        {
+            rows[row + word].store(seeds[word], std::memory_order_relaxed);
+            changed = true;
+        }
+    }
+
+    return changed;
+}
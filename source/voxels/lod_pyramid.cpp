@@ -0,0 +1,123 @@
+#include <voxel-blaze/parallel.hpp>
+#include <voxel-blaze/trace.hpp>
+#include <voxel-blaze/voxels/lod_pyramid.hpp>
+
+LodPyramid::LodPyramid(const VoxelGrid &grid, const unsigned max_levels, const ColorMode color_mode) : source(grid)
+{
+    TRACE_ZONE("Build LOD pyramid");
+
+    // Stop once a level collapses to a single voxel.
+    while (level_count() < max_levels && get_level(level_count() - 1).max_size() > 1)
+    {
+        levels.push_back(downsample(get_level(level_count() - 1), color_mode));
+    }
+
+    spdlog::info("Built a LOD pyramid with {} levels.", level_count());
+}
+
+size_t LodPyramid::level_count() const
+{
+    return levels.size() + 1;
+}
+
+const VoxelGrid &LodPyramid::get_level(const size_t level) const
+{
+    return level == 0 ? source : *levels.at(level - 1);
+}
+
+std::vector<Mesh> LodPyramid::meshify(const std::function<Mesh(const VoxelGrid &)> &mesher) const
+{
+    std::vector<Mesh> meshes(level_count());
+
+    parallel_for(level_count(), [&](const size_t begin, const size_t end) {
+        for (size_t level = begin; level < end; level++)
+        {
+            meshes[level] = mesher(get_level(level));
+        }
+    });
+
+    return meshes;
+}
+
+std::unique_ptr<ArrayVoxelGrid> LodPyramid::downsample(const VoxelGrid &grid, const ColorMode color_mode)
+{
+    PROFILE_ZONE("Downsample grid");
+    const glm::uvec3 size = grid.get_size();
+    const glm::uvec3 half_size = glm::uvec3((size.x + 1) / 2, (size.y + 1) / 2, (size.z + 1) / 2);
+    auto result = std::make_unique<ArrayVoxelGrid>(half_size.x, half_size.y, half_size.z);
+
+    // Array grids store every voxel separately, so distinct voxels can be written from several threads.
+    parallel_for(half_size.z, [&](const size_t begin, const size_t end) {
+        std::array<Voxel, 8> children;
+
+        for (unsigned z = begin; z < end; z++)
+        {
+            for (unsigned y = 0; y < half_size.y; y++)
+            {
+                for (unsigned x = 0; x < half_size.x; x++)
+                {
+                    unsigned cell_count = 0;
+                    unsigned child_count = 0;
+
+                    // Blocks at the border of odd sized grids are smaller.
+                    for (unsigned dz = 0; dz < 2 && z * 2 + dz < size.z; dz++)
+                    {
+                        for (unsigned dy = 0; dy < 2 && y * 2 + dy < size.y; dy++)
+                        {
+                            for (unsigned dx = 0; dx < 2 && x * 2 + dx < size.x; dx++)
+                            {
+                                const auto voxel = grid.get_voxel(x * 2 + dx, y * 2 + dy, z * 2 + dz);
+                                cell_count += 1;
+
+                                if (voxel.has_value())
+                                {
+                                    children[child_count++] = *voxel;
+                                }
+                            }
+                        }
+                    }
+
+                    // Half occupied blocks stay occupied, so thin surfaces do not erode away.
+                    if (child_count * 2 < cell_count)
+                    {
+                        continue;
+                    }
+
+                    Voxel voxel = children[0];
+
+                    if (color_mode == ColorMode::Average)
+                    {
+                        voxel = Voxel{0.0f, 0.0f, 0.0f};
+
+                        for (unsigned i = 0; i < child_count; i++)
+                        {
+                            voxel.r += children[i].r / child_count;
+                            voxel.g += children[i].g / child_count;
+                            voxel.b += children[i].b / child_count;
+                        }
+                    }
+                    else
+                    {
+                        unsigned best_count = 0;
+
+                        for (unsigned i = 0; i < child_count; i++)
+                        {
+                            const unsigned count =
+                                std::count(children.begin(), children.begin() + child_count, children[i]);
+
+                            if (count > best_count)
+                            {
+                                best_count = count;
+                                voxel = children[i];
+                            }
+                        }
+                    }
+
+                    result->set_voxel(x, y, z, voxel);
+                }
+            }
+        }
+    });
+
+    return result;
+}
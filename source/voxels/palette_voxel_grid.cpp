@@ -0,0 +1,146 @@
+#include <voxel-blaze/hash.hpp>
+#include <voxel-blaze/voxels/palette_voxel_grid.hpp>
+
+PaletteVoxelGrid::PaletteVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z)
+    : VoxelGrid(size_x, size_y, size_z), indices(size_t(size_x) * size_y * size_z, 0)
+{
+}
+
+std::optional<Voxel> PaletteVoxelGrid::get_voxel(const unsigned x, const unsigned y, const unsigned z) const
+{
+    if (x >= size_x || y >= size_y || z >= size_z)
+    {
+        return std::nullopt;
+    }
+
+    const auto index = indices[calculate_index(x, y, z)];
+
+    if (index == 0)
+    {
+        return std::nullopt;
+    }
+
+    return palette[index];
+}
+
+void PaletteVoxelGrid::set_voxel(const unsigned x, const unsigned y, const unsigned z,
+                                 const std::optional<Voxel> &voxel)
+{
+    indices[calculate_index(x, y, z)] = voxel.has_value() ? palette.find_or_add(*voxel) : 0;
+}
+
+void PaletteVoxelGrid::set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette)
+{
+    PaletteRemap remap(this->palette, palette);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto entry = entries[i];
+
+        if (entry.x < size_x && entry.y < size_y && entry.z < size_z)
+        {
+            indices[calculate_index(entry.x, entry.y, entry.z)] = remap(entry.i);
+        }
+    }
+}
+
+void PaletteVoxelGrid::set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors)
+{
+    if (colors.size() > 255)
+    {
+        throw std::runtime_error("Too many colors for voxel indices");
+    }
+
+    std::array<uint8_t, 256> remap = {};
+
+    for (size_t i = 0; i < colors.size(); i++)
+    {
+        remap[i + 1] = palette.find_or_add(colors[i]);
+    }
+
+    for (size_t i = 0; i < this->indices.size(); i++)
+    {
+        if (indices[i] != 0)
+        {
+            this->indices[i] = remap[indices[i]];
+        }
+    }
+}
+
+void PaletteVoxelGrid::fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y, const unsigned z,
+                                     const std::optional<Voxel> &voxel)
+{
+    if (y >= size_y || z >= size_z || begin_x >= std::min(end_x, size_x))
+    {
+        return;
+    }
+
+    const uint8_t index = voxel.has_value() ? palette.find_or_add(*voxel) : 0;
+    std::memset(indices.data() + calculate_index(begin_x, y, z), index, std::min(end_x, size_x) - begin_x);
+}
+
+void PaletteVoxelGrid::get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const
+{
+    const uint8_t *row = indices.data() + calculate_index(0, y, z);
+
+    for (unsigned word = 0; word * 64 < size_x; word++)
+    {
+        uint64_t bits = 0;
+
+        for (unsigned bit = 0; bit < 64 && word * 64 + bit < size_x; bit++)
+        {
+            bits |= uint64_t(row[word * 64 + bit] != 0) << bit;
+        }
+
+        words[word] = bits;
+    }
+}
+
+uint64_t PaletteVoxelGrid::hash_contents() const
+{
+    const uint64_t hash = hash_mix(size_x ^ (uint64_t(size_y) << 21) ^ (uint64_t(size_z) << 42));
+    const auto &colors = palette.get_colors();
+    return hash_bytes(colors.data(), sizeof(colors), hash_bytes(indices.data(), indices.size(), hash));
+}
+
+uint8_t PaletteVoxelGrid::get_index(const unsigned x, const unsigned y, const unsigned z) const
+{
+    return indices[calculate_index(x, y, z)];
+}
+
+void PaletteVoxelGrid::set_index(const unsigned x, const unsigned y, const unsigned z, const uint8_t index)
+{
+    indices[calculate_index(x, y, z)] = palette.use(index);
+}
+
+void PaletteVoxelGrid::set_indices(const uint8_t *indices, const Palette &palette)
+{
+    // Replaces the whole grid, `indices` has to use the same x-major layout.
+    std::memcpy(this->indices.data(), indices, this->indices.size());
+    this->palette.assign(palette);
+
+    // Only the slots the indices refer to are used, the rest stay free for later edits.
+    std::bitset<256> present;
+    for (const auto index : this->indices)
+    {
+        present.set(index);
+    }
+
+    for (unsigned i = 1; i < 256; i++)
+    {
+        if (present[i])
+        {
+            this->palette.use(i);
+        }
+    }
+}
+
+const Palette &PaletteVoxelGrid::get_palette() const
+{
+    return palette.get_colors();
+}
+
+size_t PaletteVoxelGrid::calculate_index(const unsigned x, const unsigned y, const unsigned z) const
+{
+    return x + size_t(size_x) * (y + size_t(size_y) * z);
+}
@@ -0,0 +1,561 @@
+#include <voxel-blaze/parallel.hpp>
+#include <voxel-blaze/trace.hpp>
+#include <voxel-blaze/voxels/exterior_mask.hpp>
+#include <voxel-blaze/voxels/rle_column_voxel_grid.hpp>
+
+namespace
+{
+    using Column = RleColumnVoxelGrid::Column;
+
+    // Calls `function(start, end, index)` for every part of the runs of `column` that `cover` does not occupy. A
+    // missing cover occupies nothing.
+    template <typename Function>
+    inline void for_each_uncovered(const Column &column, const Column *cover, Function function)
+    {
+        size_t next = 0;
+
+        for (const auto &run : column)
+        {
+            unsigned z = run.start;
+
+            while (z < run.end())
+            {
+                while (cover && next < cover->size() && (*cover)[next].end() <= z)
+                {
+                    next++;
+                }
+
+                if (!cover || next == cover->size())
+                {
+                    function(z, run.end(), run.index);
+                    break;
+                }
+
+                if ((*cover)[next].start <= z)
+                {
+                    z = (*cover)[next].end();
+                    continue;
+                }
+
+                const unsigned gap_end = std::min(run.end(), (*cover)[next].start);
+                function(z, gap_end, run.index);
+                z = gap_end;
+            }
+        }
+    }
+
+    // Top faces of runs not followed directly by another run, bottom faces of runs not directly preceded by one.
+    template <typename Function>
+    inline void for_each_cap(const Column &column, Function function)
+    {
+        for (size_t i = 0; i < column.size(); i++)
+        {
+            if (i == 0 || column[i - 1].end() != column[i].start)
+            {
+                function(column[i].start, Face::Direction::Front, column[i].index);
+            }
+
+            if (i + 1 == column.size() || column[i + 1].start != column[i].end())
+            {
+                function(column[i].end(), Face::Direction::Back, column[i].index);
+            }
+        }
+    }
+}
+
+RleColumnVoxelGrid::RleColumnVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z)
+    : VoxelGrid(size_x, size_y, size_z), columns(size_t(size_x) * size_y)
+{
+}
+
+std::optional<Voxel> RleColumnVoxelGrid::get_voxel(const unsigned x, const unsigned y, const unsigned z) const
+{
+    const auto index = get_index(x, y, z);
+
+    if (index == 0)
+    {
+        return std::nullopt;
+    }
+
+    return palette[index];
+}
+
+void RleColumnVoxelGrid::set_voxel(const unsigned x, const unsigned y, const unsigned z,
+                                   const std::optional<Voxel> &voxel)
+{
+    if (x >= size_x || y >= size_y || z >= size_z)
+    {
+        return;
+    }
+
+    write_span(columns[x + size_t(size_x) * y], z, z + 1, voxel.has_value() ? palette.find_or_add(*voxel) : 0);
+}
+
+void RleColumnVoxelGrid::set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette)
+{
+    PaletteRemap remap(this->palette, palette);
+
+    // Bucket the entries by column, then rebuild every touched column once.
+    std::vector<size_t> offsets(columns.size() + 1, 0);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto entry = entries[i];
+
+        if (entry.x < size_x && entry.y < size_y && entry.z < size_z)
+        {
+            offsets[entry.x + size_t(size_x) * entry.y + 1]++;
+        }
+    }
+
+    for (size_t column = 0; column < columns.size(); column++)
+    {
+        offsets[column + 1] += offsets[column];
+    }
+
+    std::vector<IndexedVoxel> sorted(offsets.back());
+    std::vector<size_t> cursors(offsets.begin(), offsets.end() - 1);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto entry = entries[i];
+
+        if (entry.x < size_x && entry.y < size_y && entry.z < size_z)
+        {
+            sorted[cursors[entry.x + size_t(size_x) * entry.y]++] = entry;
+        }
+    }
+
+    std::vector<uint8_t> scratch(size_z);
+
+    for (size_t column = 0; column < columns.size(); column++)
+    {
+        if (offsets[column] == offsets[column + 1])
+        {
+            continue;
+        }
+
+        decode(columns[column], scratch.data());
+
+        for (size_t i = offsets[column]; i < offsets[column + 1]; i++)
+        {
+            scratch[sorted[i].z] = remap(sorted[i].i);
+        }
+
+        encode(scratch.data(), columns[column]);
+    }
+}
+
+void RleColumnVoxelGrid::set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors)
+{
+    if (colors.size() > 255)
+    {
+        throw std::runtime_error("Too many colors for voxel indices");
+    }
+
+    std::array<uint8_t, 256> remap = {};
+
+    for (size_t i = 0; i < colors.size(); i++)
+    {
+        remap[i + 1] = palette.find_or_add(colors[i]);
+    }
+
+    // Columns are independent, so rows of columns are rebuilt on separate threads.
+    parallel_for(size_y, [&](const size_t begin, const size_t end) {
+        std::vector<uint8_t> scratch(size_z);
+
+        for (unsigned y = begin; y < end; y++)
+        {
+            for (unsigned x = 0; x < size_x; x++)
+            {
+                auto &column = columns[x + size_t(size_x) * y];
+                decode(column, scratch.data());
+                bool changed = false;
+
+                for (unsigned z = 0; z < size_z; z++)
+                {
+                    const uint8_t index = indices[x + size_t(size_x) * (y + size_t(size_y) * z)];
+
+                    if (index != 0)
+                    {
+                        scratch[z] = remap[index];
+                        changed = true;
+                    }
+                }
+
+                if (changed)
+                {
+                    encode(scratch.data(), column);
+                }
+            }
+        }
+    });
+}
+
+void RleColumnVoxelGrid::fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y,
+                                       const unsigned z, const std::optional<Voxel> &voxel)
+{
+    if (y >= size_y || z >= size_z)
+    {
+        return;
+    }
+
+    const uint8_t index = voxel.has_value() ? palette.find_or_add(*voxel) : 0;
+
+    for (unsigned x = begin_x; x < std::min(end_x, size_x); x++)
+    {
+        write_span(columns[x + size_t(size_x) * y], z, z + 1, index);
+    }
+}
+
+void RleColumnVoxelGrid::get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const
+{
+    std::fill(words, words + (size_x + 63) / 64, 0);
+
+    for (unsigned x = 0; x < size_x; x++)
+    {
+        words[x / 64] |= uint64_t(get_index(x, y, z) != 0) << (x % 64);
+    }
+}
+
+glm::uvec3 RleColumnVoxelGrid::get_tile_size() const
+{
+    return glm::uvec3(1, 1, size_z);
+}
+
+uint8_t RleColumnVoxelGrid::get_index(const unsigned x, const unsigned y, const unsigned z) const
+{
+    const auto column = find_column(x, y);
+
+    if (!column || z >= size_z)
+    {
+        return 0;
+    }
+
+    // Last run starting at or before z.
+    const auto run = std::upper_bound(column->begin(), column->end(), z,
+                                      [](const unsigned z, const Run &run) { return z < run.start; });
+
+    if (run == column->begin() || std::prev(run)->end() <= z)
+    {
+        return 0;
+    }
+
+    return std::prev(run)->index;
+}
+
+const RleColumnVoxelGrid::Column &RleColumnVoxelGrid::get_column(const unsigned x, const unsigned y) const
+{
+    return columns.at(x + size_t(size_x) * y);
+}
+
+const Palette &RleColumnVoxelGrid::get_palette() const
+{
+    return palette.get_colors();
+}
+
+size_t RleColumnVoxelGrid::run_count() const
+{
+    size_t count = 0;
+
+    for (const auto &column : columns)
+    {
+        count += column.size();
+    }
+
+    return count;
+}
+
+size_t RleColumnVoxelGrid::storage_bytes() const
+{
+    return columns.size() * sizeof(Column) + run_count() * sizeof(Run) + sizeof(Palette);
+}
+
+Mesh RleColumnVoxelGrid::meshify_culled_faces(const ExteriorMask *exterior) const
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned> indices;
+    std::unordered_map<Vertex, unsigned> map;
+
+    const auto positive_x_face = {2, 6, 5, 5, 1, 2};
+    const auto negative_x_face = {0, 4, 7, 7, 3, 0};
+    const auto positive_y_face = {2, 3, 7, 7, 6, 2};
+    const auto negative_y_face = {1, 5, 4, 4, 0, 1};
+    const auto positive_z_face = {4, 5, 6, 6, 7, 4};
+    const auto negative_z_face = {0, 2, 1, 2, 0, 3};
+
+    const auto add_face = [&](const unsigned x, const unsigned y, const unsigned z, const uint8_t index,
+                              const std::initializer_list<int> &face) {
+        const auto &voxel = palette[index];
+        const auto base = Vertex{(float)x - (float)size_x / 2.0f,
+                                 (float)y - (float)size_y / 2.0f,
+                                 (float)z - (float)size_z / 2.0f,
+                                 voxel.r,
+                                 voxel.g,
+                                 voxel.b};
+
+        const auto single_vertices = Vertex::generate_cube_vertices(base);
+
+        for (const auto i : face)
+        {
+            const auto vertex = single_vertices[i];
+            const auto it = map.find(vertex);
+
+            if (it != map.end())
+            {
+                indices.push_back(it->second);
+            }
+            else
+            {
+                map[vertex] = vertices.size();
+                indices.push_back(vertices.size());
+                vertices.push_back(vertex);
+            }
+        }
+    };
+
+    const auto is_exterior = [&](const unsigned x, const unsigned y, const unsigned z) {
+        return !exterior || exterior->is_exterior(x, y, z);
+    };
+
+    for (unsigned y = 0; y < size_y; y++)
+    {
+        for (unsigned x = 0; x < size_x; x++)
+        {
+            const auto &column = columns[x + size_t(size_x) * y];
+
+            // Side faces only exist where the neighbouring column leaves a gap next to a run.
+            const auto add_side_faces = [&](const int dx, const int dy, const std::initializer_list<int> &face) {
+                const unsigned neighbour_x = x + dx;
+                const unsigned neighbour_y = y + dy;
+
+                for_each_uncovered(column, find_column(neighbour_x, neighbour_y),
+                                   [&](const unsigned start, const unsigned end, const uint8_t index) {
+                                       for (unsigned z = start; z < end; z++)
+                                       {
+                                           if (is_exterior(neighbour_x, neighbour_y, z))
+                                           {
+                                               add_face(x, y, z, index, face);
+                                           }
+                                       }
+                                   });
+            };
+
+            add_side_faces(1, 0, positive_x_face);
+            add_side_faces(-1, 0, negative_x_face);
+            add_side_faces(0, 1, positive_y_face);
+            add_side_faces(0, -1, negative_y_face);
+
+            for_each_cap(column, [&](const unsigned z, const Face::Direction direction, const uint8_t index) {
+                if (direction == Face::Direction::Back && is_exterior(x, y, z))
+                {
+                    add_face(x, y, z - 1, index, positive_z_face);
+                }
+                else if (direction == Face::Direction::Front && is_exterior(x, y, z - 1))
+                {
+                    add_face(x, y, z, index, negative_z_face);
+                }
+            });
+        }
+    }
+
+    spdlog::info("Meshified (culled) with {} vertices and {} triangle faces ({} square faces).", vertices.size(),
+                 indices.size() / 3, indices.size() / 3 / 2);
+
+    return Mesh{indices, vertices};
+}
+
+Mesh RleColumnVoxelGrid::meshify_greedy_faces(const ExteriorMask *exterior) const
+{
+    struct Cap
+    {
+        unsigned x, y;
+        Face::Direction direction;
+        uint8_t index;
+    };
+
+    const auto is_exterior = [&](const unsigned x, const unsigned y, const unsigned z) {
+        return !exterior || exterior->is_exterior(x, y, z);
+    };
+
+    // Faces across z only sit at the ends of runs, so they are sorted into their slices up front.
+    std::vector<std::vector<Cap>> caps(size_z + 1);
+
+    for (unsigned y = 0; y < size_y; y++)
+    {
+        for (unsigned x = 0; x < size_x; x++)
+        {
+            for_each_cap(columns[x + size_t(size_x) * y],
+                         [&](const unsigned z, const Face::Direction direction, const uint8_t index) {
+                             // Back faces look into the slice's own cell, front faces into the one behind it.
+                             if (is_exterior(x, y, direction == Face::Direction::Back ? z : z - 1))
+                             {
+                                 caps[z].push_back({x, y, direction, index});
+                             }
+                         });
+        }
+    }
+
+    return meshify_greedy_masks([&](const unsigned dimension, const unsigned slice, Mask2D &mask) {
+        const auto enable = [&](const unsigned x, const unsigned y, const unsigned z, const Face::Direction direction,
+                                const uint8_t index) {
+            const auto &voxel = palette[index];
+            const Face face = {voxel.r, voxel.g, voxel.b, direction};
+
+            // Masks span the two other dimensions in cyclic order.
+            if (dimension == 0)
+            {
+                mask.enable(y, z, face);
+            }
+            else if (dimension == 1)
+            {
+                mask.enable(z, x, face);
+            }
+            else
+            {
+                mask.enable(x, y, face);
+            }
+        };
+
+        if (dimension == 2)
+        {
+            for (const auto &cap : caps[slice])
+            {
+                enable(cap.x, cap.y, slice, cap.direction, cap.index);
+            }
+
+            std::vector<Cap>().swap(caps[slice]);
+            return;
+        }
+
+        // Columns before and after the slice, compared run against run.
+        const unsigned count = dimension == 0 ? size_y : size_x;
+
+        for (unsigned i = 0; i < count; i++)
+        {
+            const unsigned x = dimension == 0 ? slice : i;
+            const unsigned y = dimension == 0 ? i : slice;
+            const unsigned behind_x = dimension == 0 ? x - 1 : x;
+            const unsigned behind_y = dimension == 0 ? y : y - 1;
+            const auto column = find_column(x, y);
+            const auto behind = find_column(behind_x, behind_y);
+
+            if (behind)
+            {
+                for_each_uncovered(*behind, column, [&](const unsigned start, const unsigned end, const uint8_t index) {
+                    for (unsigned z = start; z < end; z++)
+                    {
+                        if (is_exterior(x, y, z))
+                        {
+                            enable(x, y, z, Face::Direction::Back, index);
+                        }
+                    }
+                });
+            }
+
+            if (column)
+            {
+                for_each_uncovered(*column, behind, [&](const unsigned start, const unsigned end, const uint8_t index) {
+                    for (unsigned z = start; z < end; z++)
+                    {
+                        if (is_exterior(behind_x, behind_y, z))
+                        {
+                            enable(x, y, z, Face::Direction::Front, index);
+                        }
+                    }
+                });
+            }
+        }
+    });
+}
+
+const RleColumnVoxelGrid::Column *RleColumnVoxelGrid::find_column(const unsigned x, const unsigned y) const
+{
+    if (x >= size_x || y >= size_y)
+    {
+        return nullptr;
+    }
+
+    return &columns[x + size_t(size_x) * y];
+}
+
+void RleColumnVoxelGrid::write_span(Column &column, const unsigned begin, const unsigned end, const uint8_t index)
+{
+    // Runs overlapping [begin, end) are replaced by their uncovered remainders and the new run.
+    const auto first = std::partition_point(column.begin(), column.end(),
+                                            [&](const Run &run) { return run.end() <= begin; });
+    const auto last = std::partition_point(first, column.end(), [&](const Run &run) { return run.start < end; });
+
+    std::array<Run, 3> replacement;
+    size_t replacement_count = 0;
+
+    if (first != last && first->start < begin)
+    {
+        replacement[replacement_count++] = {first->start, begin - first->start, first->index};
+    }
+
+    if (index != 0)
+    {
+        replacement[replacement_count++] = {begin, end - begin, index};
+    }
+
+    if (first != last && std::prev(last)->end() > end)
+    {
+        replacement[replacement_count++] = {end, std::prev(last)->end() - end, std::prev(last)->index};
+    }
+
+    const size_t position = first - column.begin();
+    column.erase(first, last);
+    column.insert(column.begin() + position, replacement.begin(), replacement.begin() + replacement_count);
+
+    // Only the replaced range and its direct neighbours can have become mergeable.
+    size_t i = position > 0 ? position - 1 : 0;
+    size_t merge_end = std::min(position + replacement_count + 1, column.size());
+
+    while (i + 1 < merge_end)
+    {
+        if (column[i].end() == column[i + 1].start && column[i].index == column[i + 1].index)
+        {
+            column[i].length += column[i + 1].length;
+            column.erase(column.begin() + i + 1);
+            merge_end--;
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+void RleColumnVoxelGrid::decode(const Column &column, uint8_t *indices) const
+{
+    std::memset(indices, 0, size_z);
+
+    for (const auto &run : column)
+    {
+        std::memset(indices + run.start, run.index, run.length);
+    }
+}
+
+void RleColumnVoxelGrid::encode(const uint8_t *indices, Column &column) const
+{
+    column.clear();
+
+    for (unsigned z = 0; z < size_z;)
+    {
+        unsigned end = z + 1;
+        while (end < size_z && indices[end] == indices[z])
+        {
+            end++;
+        }
+
+        if (indices[z] != 0)
+        {
+            column.push_back({z, end - z, indices[z]});
+        }
+
+        z = end;
+    }
+
+    column.shrink_to_fit();
+}
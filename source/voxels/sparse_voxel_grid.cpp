@@ -0,0 +1,240 @@
+#include <atomic>
+#include <voxel-blaze/trace.hpp>
+#include <voxel-blaze/voxels/sparse_voxel_grid.hpp>
+
+SparseVoxelGrid::SparseVoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z)
+    : VoxelGrid(size_x, size_y, size_z)
+{
+}
+
+std::optional<Voxel> SparseVoxelGrid::get_voxel(const unsigned x, const unsigned y, const unsigned z) const
+{
+    const auto index = get_index(x, y, z);
+
+    if (index == 0)
+    {
+        return std::nullopt;
+    }
+
+    return palette[index];
+}
+
+void SparseVoxelGrid::set_voxel(const unsigned x, const unsigned y, const unsigned z, const std::optional<Voxel> &voxel)
+{
+    set_index(x, y, z, voxel.has_value() ? palette.find_or_add(*voxel) : 0);
+}
+
+void SparseVoxelGrid::set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette)
+{
+    PaletteRemap remap(this->palette, palette);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto entry = entries[i];
+
+        if (entry.x < size_x && entry.y < size_y && entry.z < size_z)
+        {
+            set_index(entry.x, entry.y, entry.z, remap(entry.i));
+        }
+    }
+}
+
+void SparseVoxelGrid::set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors)
+{
+    if (colors.size() > 255)
+    {
+        throw std::runtime_error("Too many colors for voxel indices");
+    }
+
+    std::array<uint8_t, 256> remap = {};
+
+    for (size_t i = 0; i < colors.size(); i++)
+    {
+        remap[i + 1] = palette.find_or_add(colors[i]);
+    }
+
+    // Walk chunk by chunk so every chunk is looked up once and only allocated when it receives a voxel.
+    for (unsigned chunk_z = 0; chunk_z < size_z; chunk_z += chunk_size)
+    {
+        for (unsigned chunk_y = 0; chunk_y < size_y; chunk_y += chunk_size)
+        {
+            for (unsigned chunk_x = 0; chunk_x < size_x; chunk_x += chunk_size)
+            {
+                const unsigned end_x = std::min(chunk_x + chunk_size, size_x);
+                const unsigned end_y = std::min(chunk_y + chunk_size, size_y);
+                const unsigned end_z = std::min(chunk_z + chunk_size, size_z);
+                Chunk *chunk = nullptr;
+
+                for (unsigned z = chunk_z; z < end_z; z++)
+                {
+                    for (unsigned y = chunk_y; y < end_y; y++)
+                    {
+                        const uint8_t *row = indices + size_t(size_x) * (y + size_t(size_y) * z);
+
+                        for (unsigned x = chunk_x; x < end_x; x++)
+                        {
+                            if (row[x] == 0)
+                            {
+                                continue;
+                            }
+
+                            if (!chunk)
+                            {
+                                chunk = &touch_chunk(chunk_x, chunk_y, chunk_z);
+                            }
+
+                            (*chunk)[calculate_index(x, y, z)] = remap[row[x]];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void SparseVoxelGrid::fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y, const unsigned z,
+                                    const std::optional<Voxel> &voxel)
+{
+    if (y >= size_y || z >= size_z)
+    {
+        return;
+    }
+
+    const uint8_t index = voxel.has_value() ? palette.find_or_add(*voxel) : 0;
+    const unsigned end = std::min(end_x, size_x);
+
+    // Chunk rows are contiguous, so the span is written as one segment per chunk it crosses.
+    for (unsigned x = begin_x; x < end;)
+    {
+        const unsigned segment_end = std::min(end, (x / chunk_size + 1) * chunk_size);
+
+        if (index != 0 || chunks.find(calculate_key(x, y, z)) != chunks.end())
+        {
+            auto &chunk = touch_chunk(x, y, z);
+            std::memset(chunk.data() + calculate_index(x, y, z), index, segment_end - x);
+        }
+
+        x = segment_end;
+    }
+}
+
+void SparseVoxelGrid::get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const
+{
+    std::fill(words, words + (size_x + 63) / 64, 0);
+
+    // Missing chunks stay zero, present ones contribute one contiguous chunk row each.
+    for (unsigned chunk_x = 0; chunk_x < size_x; chunk_x += chunk_size)
+    {
+        const auto it = chunks.find(calculate_key(chunk_x, y, z));
+
+        if (it == chunks.end())
+        {
+            continue;
+        }
+
+        const uint8_t *row = it->second->data() + calculate_index(chunk_x, y, z);
+
+        for (unsigned x = chunk_x; x < std::min(chunk_x + chunk_size, size_x); x++)
+        {
+            words[x / 64] |= uint64_t(row[x - chunk_x] != 0) << (x % 64);
+        }
+    }
+}
+
+glm::uvec3 SparseVoxelGrid::get_tile_size() const
+{
+    return glm::uvec3(chunk_size);
+}
+
+uint8_t SparseVoxelGrid::get_index(const unsigned x, const unsigned y, const unsigned z) const
+{
+    if (x >= size_x || y >= size_y || z >= size_z)
+    {
+        return 0;
+    }
+
+    const auto it = chunks.find(calculate_key(x, y, z));
+
+    if (it == chunks.end())
+    {
+        return 0;
+    }
+
+    return (*it->second)[calculate_index(x, y, z)];
+}
+
+void SparseVoxelGrid::set_index(const unsigned x, const unsigned y, const unsigned z, const uint8_t index)
+{
+    // Clearing a voxel never allocates a chunk.
+    if (index == 0 && chunks.find(calculate_key(x, y, z)) == chunks.end())
+    {
+        return;
+    }
+
+    touch_chunk(x, y, z)[calculate_index(x, y, z)] = palette.use(index);
+}
+
+const Palette &SparseVoxelGrid::get_palette() const
+{
+    return palette.get_colors();
+}
+
+void SparseVoxelGrid::set_palette(const Palette &palette)
+{
+    this->palette.assign(palette);
+}
+
+size_t SparseVoxelGrid::chunk_count() const
+{
+    return chunks.size();
+}
+
+size_t SparseVoxelGrid::shared_chunk_count() const
+{
+    return std::count_if(chunks.begin(), chunks.end(), [](const auto &entry) { return entry.second.use_count() > 1; });
+}
+
+std::unique_ptr<SparseVoxelGrid> SparseVoxelGrid::snapshot() const
+{
+    PROFILE_ZONE("Snapshot sparse grid");
+    auto result = std::make_unique<SparseVoxelGrid>(size_x, size_y, size_z);
+    result->chunks = chunks;
+    result->palette = palette;
+    return result;
+}
+
+uint64_t SparseVoxelGrid::calculate_key(const unsigned x, const unsigned y, const unsigned z) const
+{
+    const uint64_t chunk_x = x / chunk_size;
+    const uint64_t chunk_y = y / chunk_size;
+    const uint64_t chunk_z = z / chunk_size;
+    return chunk_x | (chunk_y << 21) | (chunk_z << 42);
+}
+
+unsigned SparseVoxelGrid::calculate_index(const unsigned x, const unsigned y, const unsigned z) const
+{
+    return x % chunk_size + chunk_size * (y % chunk_size + chunk_size * (z % chunk_size));
+}
+
+SparseVoxelGrid::Chunk &SparseVoxelGrid::touch_chunk(const unsigned x, const unsigned y, const unsigned z)
+{
+    auto &chunk = chunks[calculate_key(x, y, z)];
+
+    if (!chunk)
+    {
+        chunk = std::make_shared<Chunk>();
+        chunk->fill(0);
+    }
+    else if (chunk.use_count() > 1)
+    {
+        chunk = std::make_shared<Chunk>(*chunk);
+    }
+    else
+    {
+        // The last snapshot sharing the chunk may just have been released on another thread, its reads have to
+        // happen before the writes that follow.
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    return *chunk;
+}
@@ -1,5 +1,88 @@
+#include <atomic>
+#include <voxel-blaze/hash.hpp>
+#include <voxel-blaze/noise.hpp>
+#include <voxel-blaze/parallel.hpp>
+#include <voxel-blaze/trace.hpp>
+#include <voxel-blaze/voxels/exterior_mask.hpp>
 #include <voxel-blaze/voxels/voxel_grid.hpp>
 
+namespace
+{
+    // Random value in [0, 1) derived only from the seed and the position, so generated scenes do not depend on the
+    // fill order or the standard library.
+    inline float hash_position(const uint64_t seed, const unsigned x, const unsigned y, const unsigned z)
+    {
+        const uint64_t position = uint64_t(x) | (uint64_t(y) << 21) | (uint64_t(z) << 42);
+        return (hash_mix(position ^ hash_mix(seed)) >> 40) / float(1 << 24);
+    }
+
+    // Perlin noise is not seeded, the seed moves the sampled region instead.
+    inline glm::vec3 noise_offset(const uint64_t seed)
+    {
+        const uint64_t hash = hash_mix(seed);
+        return glm::vec3(hash & 0xffff, (hash >> 16) & 0xffff, (hash >> 32) & 0xffff) / 16.0f;
+    }
+
+    // Interval [begin, end) of a row where `inside` holds. The estimate from the row's center and half width is
+    // corrected by testing `inside` at its bounds, so the result matches testing every voxel.
+    template <typename Inside>
+    std::pair<unsigned, unsigned> row_interval(const float center, const float half_width, const unsigned size,
+                                               Inside inside)
+    {
+        unsigned begin = std::clamp(std::ceil(center - half_width), 0.0f, float(size));
+        unsigned end = std::clamp(std::floor(center + half_width) + 1.0f, 0.0f, float(size));
+
+        while (begin > 0 && inside(begin - 1))
+        {
+            begin--;
+        }
+
+        while (begin < end && !inside(begin))
+        {
+            begin++;
+        }
+
+        while (end < size && inside(end))
+        {
+            end++;
+        }
+
+        while (end > begin && !inside(end - 1))
+        {
+            end--;
+        }
+
+        return {begin, end};
+    }
+
+    // Visits every position tile by tile, both in x-major order, so traversal follows the storage of the grid.
+    template <typename Function>
+    void for_each_tiled(const glm::uvec3 &size, const glm::uvec3 &tile, Function function)
+    {
+        for (unsigned tile_z = 0; tile_z < size.z; tile_z += tile.z)
+        {
+            for (unsigned tile_y = 0; tile_y < size.y; tile_y += tile.y)
+            {
+                for (unsigned tile_x = 0; tile_x < size.x; tile_x += tile.x)
+                {
+                    const glm::uvec3 end = glm::min(glm::uvec3(tile_x, tile_y, tile_z) + tile, size);
+
+                    for (unsigned z = tile_z; z < end.z; z++)
+                    {
+                        for (unsigned y = tile_y; y < end.y; y++)
+                        {
+                            for (unsigned x = tile_x; x < end.x; x++)
+                            {
+                                function(x, y, z);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 VoxelGrid::VoxelGrid(const unsigned size_x, const unsigned size_y, const unsigned size_z)
     : size_x(size_x), size_y(size_y), size_z(size_z)
 {
@@ -10,22 +93,166 @@ unsigned VoxelGrid::max_size() const
     return std::max({size_x, size_y, size_z});
 }
 
-unsigned VoxelGrid::fill_cuboid(const Voxel &voxel)
+glm::uvec3 VoxelGrid::get_tile_size() const
 {
-    unsigned counter = 0;
+    return glm::uvec3(size_x, 1, 1);
+}
+
+glm::uvec3 VoxelGrid::get_size() const
+{
+    return glm::uvec3(size_x, size_y, size_z);
+}
+
+void VoxelGrid::set_voxels(const IndexedVoxel *entries, const size_t count, const Palette &palette)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto entry = entries[i];
+
+        if (entry.x < size_x && entry.y < size_y && entry.z < size_z)
+        {
+            set_voxel(entry.x, entry.y, entry.z, palette[entry.i]);
+        }
+    }
+}
+
+void VoxelGrid::set_voxel_indices(const uint8_t *indices, const std::vector<Voxel> &colors)
+{
+    // Indices use the x-major layout of the dense grids. Non-zero index `i` writes `colors[i - 1]`, zero is skipped.
+    size_t i = 0;
+
+    for (unsigned z = 0; z < size_z; z++)
+    {
+        for (unsigned y = 0; y < size_y; y++)
+        {
+            for (unsigned x = 0; x < size_x; x++, i++)
+            {
+                if (indices[i] != 0)
+                {
+                    set_voxel(x, y, z, colors[indices[i] - 1]);
+                }
+            }
+        }
+    }
+}
+
+void VoxelGrid::fill_row_span(const unsigned begin_x, const unsigned end_x, const unsigned y, const unsigned z,
+                              const std::optional<Voxel> &voxel)
+{
+    if (y >= size_y || z >= size_z)
+    {
+        return;
+    }
+
+    for (unsigned x = begin_x; x < std::min(end_x, size_x); x++)
+    {
+        set_voxel(x, y, z, voxel);
+    }
+}
+
+void VoxelGrid::get_row_occupancy(const unsigned y, const unsigned z, uint64_t *words) const
+{
+    // Bit x of the row is set when the voxel is occupied, `words` holds `(size_x + 63) / 64` entries.
+    std::fill(words, words + (size_x + 63) / 64, 0);
 
     for (unsigned x = 0; x < size_x; x++)
+    {
+        if (get_voxel(x, y, z).has_value())
+        {
+            words[x / 64] |= uint64_t(1) << (x % 64);
+        }
+    }
+}
+
+uint64_t VoxelGrid::hash_contents() const
+{
+    const unsigned word_count = (size_x + 63) / 64;
+    std::vector<uint64_t> words(word_count);
+    std::vector<Voxel> colors;
+    uint64_t hash = hash_mix(size_x ^ (uint64_t(size_y) << 21) ^ (uint64_t(size_z) << 42));
+
+    for (unsigned z = 0; z < size_z; z++)
     {
         for (unsigned y = 0; y < size_y; y++)
         {
-            for (unsigned z = 0; z < size_z; z++)
+            get_row_occupancy(y, z, words.data());
+            colors.clear();
+
+            for (unsigned word = 0; word < word_count; word++)
             {
-                set_voxel(x, y, z, voxel);
-                counter += 1;
+                for (uint64_t bits = words[word]; bits != 0; bits &= bits - 1)
+                {
+                    colors.push_back(get_voxel(word * 64 + __builtin_ctzll(bits), y, z).value());
+                }
             }
+
+            hash = hash_bytes(words.data(), word_count * sizeof(uint64_t), hash);
+            hash = hash_bytes(colors.data(), colors.size() * sizeof(Voxel), hash);
+        }
+    }
+
+    return hash;
+}
+
+unsigned VoxelGrid::fill_box(const glm::uvec3 &begin, const glm::uvec3 &end, const std::optional<Voxel> &voxel)
+{
+    const glm::uvec3 clipped_end = glm::min(end, get_size());
+
+    if (begin.x >= clipped_end.x || begin.y >= clipped_end.y || begin.z >= clipped_end.z)
+    {
+        return 0;
+    }
+
+    for (unsigned z = begin.z; z < clipped_end.z; z++)
+    {
+        for (unsigned y = begin.y; y < clipped_end.y; y++)
+        {
+            fill_row_span(begin.x, clipped_end.x, y, z, voxel);
         }
     }
 
+    return (clipped_end.x - begin.x) * (clipped_end.y - begin.y) * (clipped_end.z - begin.z);
+}
+
+unsigned VoxelGrid::fill_function(const std::function<std::optional<Voxel>(unsigned, unsigned, unsigned)> &function)
+{
+    unsigned counter = 0;
+
+    // Runs of equal voxels along x are written as one span, empty results leave the grid untouched.
+    for (unsigned z = 0; z < size_z; z++)
+    {
+        for (unsigned y = 0; y < size_y; y++)
+        {
+            std::optional<Voxel> current;
+            unsigned begin = 0;
+
+            for (unsigned x = 0; x <= size_x; x++)
+            {
+                const auto voxel = x < size_x ? function(x, y, z) : std::nullopt;
+
+                if (!(voxel == current))
+                {
+                    if (current.has_value())
+                    {
+                        fill_row_span(begin, x, y, z, current);
+                        counter += x - begin;
+                    }
+
+                    current = voxel;
+                    begin = x;
+                }
+            }
+        }
+    }
+
+    return counter;
+}
+
+unsigned VoxelGrid::fill_cuboid(const Voxel &voxel)
+{
+    TRACE_ZONE("Fill cuboid");
+    const unsigned counter = fill_box(glm::uvec3(0), get_size(), voxel);
+
     spdlog::info("Filled a total of {} voxels.", counter);
 
     return counter;
@@ -33,6 +260,7 @@ unsigned VoxelGrid::fill_cuboid(const Voxel &voxel)
 
 unsigned VoxelGrid::fill_ellipsoid(const Voxel &voxel)
 {
+    TRACE_ZONE("Fill ellipsoid");
     unsigned counter = 0;
 
     const float center_x = size_x / 2.0f;
@@ -42,105 +270,321 @@ unsigned VoxelGrid::fill_ellipsoid(const Voxel &voxel)
     const float radius_y = size_y / 2.0f;
     const float radius_z = size_z / 2.0f;
 
-    for (unsigned x = 0; x < size_x; x++)
+    for (unsigned z = 0; z < size_z; z++)
     {
         for (unsigned y = 0; y < size_y; y++)
         {
-            for (unsigned z = 0; z < size_z; z++)
+            float dy = (y - center_y) / radius_y;
+            float dz = (z - center_z) / radius_z;
+
+            const auto [begin, end] =
+                row_interval(center_x, std::sqrt(std::max(1.0f - dy * dy - dz * dz, 0.0f)) * radius_x, size_x,
+                             [&](const unsigned x) {
+                                 float dx = (x - center_x) / radius_x;
+                                 return dx * dx + dy * dy + dz * dz <= 1.0f;
+                             });
+
+            fill_row_span(begin, end, y, z, voxel);
+            counter += end - begin;
+        }
+    }
+
+    spdlog::info("Filled a total of {} voxels.", counter);
+
+    return counter;
+}
+
+unsigned VoxelGrid::fill_perlin_noise(const Voxel &voxel, float frequency, const uint64_t seed)
+{
+    TRACE_ZONE("Fill Perlin noise");
+    std::vector<uint8_t> indices(size_t(size_x) * size_y * size_z, 0);
+    std::atomic<unsigned> counter = 0;
+    const glm::vec3 offset = noise_offset(seed);
+
+    // Rows are evaluated in parallel and written to the grid in one bulk call afterwards.
+    parallel_for(size_z, [&](const size_t begin, const size_t end) {
+        PROFILE_ZONE("Evaluate noise");
+        std::vector<float> values(size_x);
+        unsigned block_counter = 0;
+
+        for (unsigned z = begin; z < end; z++)
+        {
+            for (unsigned y = 0; y < size_y; y++)
             {
-                float dx = (x - center_x) / radius_x;
-                float dy = (y - center_y) / radius_y;
-                float dz = (z - center_z) / radius_z;
+                perlin_row(glm::vec3(frequency), offset, y, z, size_x, values.data());
+                uint8_t *row = indices.data() + size_t(size_x) * (y + size_t(size_y) * z);
 
-                if (dx * dx + dy * dy + dz * dz <= 1.0f)
+                for (unsigned x = 0; x < size_x; x++)
                 {
-                    set_voxel(x, y, z, voxel);
-                    counter += 1;
+                    row[x] = values[x] > 0.0f;
+                    block_counter += row[x];
                 }
             }
         }
+
+        counter += block_counter;
+    });
+
+    set_voxel_indices(indices.data(), {voxel});
+
+    spdlog::info("Filled a total of {} voxels with Perlin noise.", counter.load());
+
+    return counter;
+}
+
+
+unsigned VoxelGrid::fill_colored_noise(const std::vector<Voxel> &colors, float frequency, const uint64_t seed)
+{
+    TRACE_ZONE("Fill colored noise");
+
+    if (colors.empty() || colors.size() > 255)
+    {
+        throw std::runtime_error("Colored noise needs between 1 and 255 colors");
     }
 
-    spdlog::info("Filled a total of {} voxels.", counter);
+    std::vector<uint8_t> indices(size_t(size_x) * size_y * size_z, 0);
+    std::atomic<unsigned> counter = 0;
+    const glm::vec3 offset = noise_offset(seed);
+
+    parallel_for(size_z, [&](const size_t begin, const size_t end) {
+        PROFILE_ZONE("Evaluate noise");
+        std::vector<float> values(size_x);
+        std::vector<float> bands(size_x);
+        unsigned block_counter = 0;
+
+        for (unsigned z = begin; z < end; z++)
+        {
+            for (unsigned y = 0; y < size_y; y++)
+            {
+                // A second, coarser noise field picks the color, giving bands of equal color to merge.
+                perlin_row(glm::vec3(frequency), offset, y, z, size_x, values.data());
+                perlin_row(glm::vec3(frequency * 0.5f), offset + 100.0f, y, z, size_x, bands.data());
+                uint8_t *row = indices.data() + size_t(size_x) * (y + size_t(size_y) * z);
+
+                for (unsigned x = 0; x < size_x; x++)
+                {
+                    if (values[x] > 0.0f)
+                    {
+                        // Perlin noise may overshoot [-1, 1] slightly.
+                        const float band = std::clamp(bands[x] * 0.5f + 0.5f, 0.0f, 1.0f);
+                        row[x] = 1 + std::min<size_t>(band * colors.size(), colors.size() - 1);
+                        block_counter += 1;
+                    }
+                }
+            }
+        }
+
+        counter += block_counter;
+    });
+
+    set_voxel_indices(indices.data(), colors);
+
+    spdlog::info("Filled a total of {} voxels with colored noise.", counter.load());
 
     return counter;
 }
 
-unsigned VoxelGrid::fill_perlin_noise(const Voxel &voxel, float frequency)
+unsigned VoxelGrid::fill_checkerboard(const Voxel &voxel)
 {
-    unsigned counter = 0;
+    TRACE_ZONE("Fill checkerboard");
 
-    for (unsigned x = 0; x < size_x; x++)
+    // No two voxels share a face, so every face is visible and nothing can be merged.
+    const unsigned counter = fill_function([&voxel](const unsigned x, const unsigned y, const unsigned z) {
+        return (x + y + z) % 2 == 0 ? std::optional<Voxel>(voxel) : std::nullopt;
+    });
+
+    spdlog::info("Filled a total of {} voxels in a checkerboard.", counter);
+
+    return counter;
+}
+
+unsigned VoxelGrid::fill_random(const Voxel &voxel, float density, const uint64_t seed)
+{
+    TRACE_ZONE("Fill random");
+
+    const unsigned counter = fill_function([&](const unsigned x, const unsigned y, const unsigned z) {
+        return hash_position(seed, x, y, z) < density ? std::optional<Voxel>(voxel) : std::nullopt;
+    });
+
+    spdlog::info("Filled a total of {} random voxels.", counter);
+
+    return counter;
+}
+
+unsigned VoxelGrid::fill_terrain(const std::vector<Voxel> &layers, float frequency, const uint64_t seed)
+{
+    TRACE_ZONE("Fill terrain");
+    const glm::vec2 offset = glm::vec2(noise_offset(seed));
+    std::vector<unsigned> heights(size_t(size_x) * size_y);
+
+    // Height runs along z like in VOX files. The first layer covers the surface, the last one everything below.
+    for (unsigned y = 0; y < size_y; y++)
     {
-        for (unsigned y = 0; y < size_y; y++)
+        for (unsigned x = 0; x < size_x; x++)
         {
-            for (unsigned z = 0; z < size_z; z++)
+            const glm::vec2 pos = glm::vec2(x, y) * frequency + offset;
+            float noise_value = 0.0f;
+            float amplitude = 0.5f;
+
+            for (unsigned octave = 0; octave < 4; octave++)
             {
-                glm::vec3 pos = glm::vec3(x, y, z) * frequency;
+                noise_value += glm::perlin(pos * float(1 << octave)) * amplitude;
+                amplitude *= 0.5f;
+            }
+
+            heights[x + size_x * y] = std::clamp((noise_value * 0.5f + 0.5f) * size_z, 1.0f, float(size_z));
+        }
+    }
 
-                float noise_value = glm::perlin(pos);
+    const unsigned counter = fill_function([&](const unsigned x, const unsigned y, const unsigned z) {
+        const unsigned height = heights[x + size_x * y];
+        return z < height ? std::optional<Voxel>(layers[std::min<size_t>(height - 1 - z, layers.size() - 1)])
+                          : std::nullopt;
+    });
 
-                if (noise_value > 0.0f)
+    spdlog::info("Filled a total of {} voxels of terrain.", counter);
+
+    return counter;
+}
+
+unsigned VoxelGrid::fill_shell(const Voxel &voxel, const unsigned thickness)
+{
+    TRACE_ZONE("Fill shell");
+    unsigned counter = 0;
+
+    const float center_x = size_x / 2.0f;
+    const float center_y = size_y / 2.0f;
+    const float center_z = size_z / 2.0f;
+    const float radius_x = size_x / 2.0f;
+    const float radius_y = size_y / 2.0f;
+    const float radius_z = size_z / 2.0f;
+    const float inner_x = std::max(radius_x - thickness, 0.0f);
+    const float inner_y = std::max(radius_y - thickness, 0.0f);
+    const float inner_z = std::max(radius_z - thickness, 0.0f);
+    const bool hollow = inner_x > 0.0f && inner_y > 0.0f && inner_z > 0.0f;
+
+    for (unsigned z = 0; z < size_z; z++)
+    {
+        for (unsigned y = 0; y < size_y; y++)
+        {
+            float dy = y - center_y;
+            float dz = z - center_z;
+
+            const float outer_rest = 1.0f - (dy * dy) / (radius_y * radius_y) - (dz * dz) / (radius_z * radius_z);
+            const auto [begin, end] =
+                row_interval(center_x, std::sqrt(std::max(outer_rest, 0.0f)) * radius_x, size_x, [&](const unsigned x) {
+                    float dx = x - center_x;
+                    return (dx * dx) / (radius_x * radius_x) + (dy * dy) / (radius_y * radius_y) +
+                               (dz * dz) / (radius_z * radius_z) <=
+                           1.0f;
+                });
+
+            // Each row of the shell is the outer interval with the inner interval cut out.
+            unsigned inner_begin = end;
+            unsigned inner_end = end;
+
+            if (hollow)
+            {
+                const float inner_rest = 1.0f - (dy * dy) / (inner_y * inner_y) - (dz * dz) / (inner_z * inner_z);
+                std::tie(inner_begin, inner_end) = row_interval(
+                    center_x, std::sqrt(std::max(inner_rest, 0.0f)) * inner_x, size_x, [&](const unsigned x) {
+                        float dx = x - center_x;
+                        return (dx * dx) / (inner_x * inner_x) + (dy * dy) / (inner_y * inner_y) +
+                                   (dz * dz) / (inner_z * inner_z) <
+                               1.0f;
+                    });
+
+                if (inner_begin >= inner_end)
                 {
-                    set_voxel(x, y, z, voxel);
-                    counter += 1;
+                    inner_begin = end;
+                    inner_end = end;
                 }
             }
+
+            inner_begin = std::clamp(inner_begin, begin, end);
+            inner_end = std::clamp(inner_end, inner_begin, end);
+            fill_row_span(begin, inner_begin, y, z, voxel);
+            fill_row_span(inner_end, end, y, z, voxel);
+            counter += (inner_begin - begin) + (end - inner_end);
         }
     }
 
-    spdlog::info("Filled a total of {} voxels with Perlin noise.", counter);
+    spdlog::info("Filled a total of {} voxels in a hollow shell.", counter);
+
+    return counter;
+}
+
+unsigned VoxelGrid::fill_walls(const Voxel &voxel, const unsigned spacing)
+{
+    TRACE_ZONE("Fill walls");
+    unsigned counter = 0;
+
+    // One voxel thick walls along x and y, exposing both faces of every wall.
+    for (unsigned z = 0; z < size_z; z++)
+    {
+        for (unsigned y = 0; y < size_y; y++)
+        {
+            if (y % spacing == 0)
+            {
+                fill_row_span(0, size_x, y, z, voxel);
+                counter += size_x;
+                continue;
+            }
+
+            for (unsigned x = 0; x < size_x; x += spacing)
+            {
+                fill_row_span(x, x + 1, y, z, voxel);
+                counter += 1;
+            }
+        }
+    }
+
+    spdlog::info("Filled a total of {} voxels in thin walls.", counter);
 
     return counter;
 }
 
 Mesh VoxelGrid::meshify_direct() const
 {
+    TRACE_ZONE("Meshify (direct)");
     std::vector<Vertex> vertices;
     std::vector<unsigned> indices;
     std::unordered_map<Vertex, unsigned> map;
 
-    for (unsigned x = 0; x < size_x; x++)
-    {
-        for (unsigned y = 0; y < size_y; y++)
+    for_each_tiled(get_size(), get_tile_size(), [&](const unsigned x, const unsigned y, const unsigned z) {
+        const auto voxel_optional = get_voxel(x, y, z);
+
+        if (voxel_optional.has_value())
         {
-            for (unsigned z = 0; z < size_z; z++)
+            const auto voxel = voxel_optional.value();
+            const auto base = Vertex{(float)x - (float)size_x / 2.0f,
+                                     (float)y - (float)size_y / 2.0f,
+                                     (float)z - (float)size_z / 2.0f,
+                                     voxel.r,
+                                     voxel.g,
+                                     voxel.b};
+
+            const auto single_vertices = Vertex::generate_cube_vertices(base);
+            const auto single_indices = Vertex::generate_cube_indices();
+
+            for (const auto i : single_indices)
             {
-                const auto voxel_optional = get_voxel(x, y, z);
+                const auto vertex = single_vertices[i];
+                const auto it = map.find(vertex);
 
-                if (voxel_optional.has_value())
+                if (it != map.end())
                 {
-                    const auto voxel = voxel_optional.value();
-                    const auto base = Vertex{(float)x - (float)size_x / 2.0f,
-                                             (float)y - (float)size_y / 2.0f,
-                                             (float)z - (float)size_z / 2.0f,
-                                             voxel.r,
-                                             voxel.g,
-                                             voxel.b};
-
-                    const auto single_vertices = Vertex::generate_cube_vertices(base);
-                    const auto single_indices = Vertex::generate_cube_indices();
-
-                    for (const auto i : single_indices)
-                    {
-                        const auto vertex = single_vertices[i];
-                        const auto it = map.find(vertex);
-
-                        if (it != map.end())
-                        {
-                            indices.push_back(it->second);
-                        }
-                        else
-                        {
-                            map[vertex] = vertices.size();
-                            indices.push_back(vertices.size());
-                            vertices.push_back(vertex);
-                        }
-                    }
+                    indices.push_back(it->second);
+                }
+                else
+                {
+                    map[vertex] = vertices.size();
+                    indices.push_back(vertices.size());
+                    vertices.push_back(vertex);
                 }
             }
         }
-    }
+    });
 
     spdlog::info("Meshified (direct) with {} vertices and {} triangle faces ({} square faces).", vertices.size(),
                  indices.size() / 3, indices.size() / 3 / 2);
@@ -149,90 +593,102 @@ Mesh VoxelGrid::meshify_direct() const
 }
 
 Mesh VoxelGrid::meshify_culled() const
+{
+    TRACE_ZONE("Meshify (culled)");
+    return meshify_culled_faces(nullptr);
+}
+
+Mesh VoxelGrid::meshify_culled_exterior() const
+{
+    TRACE_ZONE("Meshify (culled, exterior)");
+    const ExteriorMask exterior(*this);
+    return meshify_culled_faces(&exterior);
+}
+
+// Without an exterior mask every face against air is emitted, with one only faces against exterior air.
+Mesh VoxelGrid::meshify_culled_faces(const ExteriorMask *exterior) const
 {
     std::vector<Vertex> vertices;
     std::vector<unsigned> indices;
     std::unordered_map<Vertex, unsigned> map;
 
-    for (unsigned x = 0; x < size_x; x++)
-    {
-        for (unsigned y = 0; y < size_y; y++)
+    const auto is_visible = [&](const unsigned x, const unsigned y, const unsigned z) {
+        return (x >= size_x || y >= size_y || z >= size_z || !get_voxel(x, y, z).has_value()) &&
+               (!exterior || exterior->is_exterior(x, y, z));
+    };
+
+    for_each_tiled(get_size(), get_tile_size(), [&](const unsigned x, const unsigned y, const unsigned z) {
+        const auto voxel_optional = get_voxel(x, y, z);
+
+        if (voxel_optional.has_value())
         {
-            for (unsigned z = 0; z < size_z; z++)
+            const auto voxel = voxel_optional.value();
+            const auto base = Vertex{(float)x - (float)size_x / 2.0f,
+                                     (float)y - (float)size_y / 2.0f,
+                                     (float)z - (float)size_z / 2.0f,
+                                     voxel.r,
+                                     voxel.g,
+                                     voxel.b};
+
+            const auto single_vertices = Vertex::generate_cube_vertices(base);
+
+            const auto positive_x_face = {2, 6, 5, 5, 1, 2};
+            const auto negative_x_face = {0, 4, 7, 7, 3, 0};
+            const auto positive_y_face = {2, 3, 7, 7, 6, 2};
+            const auto negative_y_face = {1, 5, 4, 4, 0, 1};
+            const auto positive_z_face = {4, 5, 6, 6, 7, 4};
+            const auto negative_z_face = {0, 2, 1, 2, 0, 3};
+
+            auto single_indices = std::vector<unsigned>{};
+
+            if (is_visible(x + 1, y, z))
             {
-                const auto voxel_optional = get_voxel(x, y, z);
-
-                if (voxel_optional.has_value())
-                {
-                    const auto voxel = voxel_optional.value();
-                    const auto base = Vertex{(float)x - (float)size_x / 2.0f,
-                                             (float)y - (float)size_y / 2.0f,
-                                             (float)z - (float)size_z / 2.0f,
-                                             voxel.r,
-                                             voxel.g,
-                                             voxel.b};
-
-                    const auto single_vertices = Vertex::generate_cube_vertices(base);
-
-                    const auto positive_x_face = {2, 6, 5, 5, 1, 2};
-                    const auto negative_x_face = {0, 4, 7, 7, 3, 0};
-                    const auto positive_y_face = {2, 3, 7, 7, 6, 2};
-                    const auto negative_y_face = {1, 5, 4, 4, 0, 1};
-                    const auto positive_z_face = {4, 5, 6, 6, 7, 4};
-                    const auto negative_z_face = {0, 2, 1, 2, 0, 3};
-
-                    auto single_indices = std::vector<unsigned>{};
-
-                    if (x == size_x - 1 || !get_voxel(x + 1, y, z).has_value())
-                    {
-                        single_indices.insert(single_indices.end(), positive_x_face.begin(), positive_x_face.end());
-                    }
+                single_indices.insert(single_indices.end(), positive_x_face.begin(), positive_x_face.end());
+            }
 
-                    if (x == 0 || !get_voxel(x - 1, y, z).has_value())
-                    {
-                        single_indices.insert(single_indices.end(), negative_x_face.begin(), negative_x_face.end());
-                    }
+            if (is_visible(x - 1, y, z))
+            {
+                single_indices.insert(single_indices.end(), negative_x_face.begin(), negative_x_face.end());
+            }
 
-                    if (y == size_y - 1 || !get_voxel(x, y + 1, z).has_value())
-                    {
-                        single_indices.insert(single_indices.end(), positive_y_face.begin(), positive_y_face.end());
-                    }
+            if (is_visible(x, y + 1, z))
+            {
+                single_indices.insert(single_indices.end(), positive_y_face.begin(), positive_y_face.end());
+            }
 
-                    if (y == 0 || !get_voxel(x, y - 1, z).has_value())
-                    {
-                        single_indices.insert(single_indices.end(), negative_y_face.begin(), negative_y_face.end());
-                    }
+            if (is_visible(x, y - 1, z))
+            {
+                single_indices.insert(single_indices.end(), negative_y_face.begin(), negative_y_face.end());
+            }
 
-                    if (z == size_z - 1 || !get_voxel(x, y, z + 1).has_value())
-                    {
-                        single_indices.insert(single_indices.end(), positive_z_face.begin(), positive_z_face.end());
-                    }
+            if (is_visible(x, y, z + 1))
+            {
+                single_indices.insert(single_indices.end(), positive_z_face.begin(), positive_z_face.end());
+            }
 
-                    if (z == 0 || !get_voxel(x, y, z - 1).has_value())
-                    {
-                        single_indices.insert(single_indices.end(), negative_z_face.begin(), negative_z_face.end());
-                    }
+            if (is_visible(x, y, z - 1))
+            {
+                single_indices.insert(single_indices.end(), negative_z_face.begin(), negative_z_face.end());
+            }
 
-                    for (const auto i : single_indices)
-                    {
-                        const auto vertex = single_vertices[i];
-                        const auto it = map.find(vertex);
+            for (const auto i : single_indices)
+            {
+                const auto vertex = single_vertices[i];
+                const auto it = map.find(vertex);
 
-                        if (it != map.end())
-                        {
-                            indices.push_back(it->second);
-                        }
-                        else
-                        {
-                            map[vertex] = vertices.size();
-                            indices.push_back(vertices.size());
-                            vertices.push_back(vertex);
-                        }
-                    }
+                if (it != map.end())
+                {
+                    indices.push_back(it->second);
+                }
+                else
+                {
+                    map[vertex] = vertices.size();
+                    indices.push_back(vertices.size());
+                    vertices.push_back(vertex);
                 }
             }
         }
-    }
+    });
 
     spdlog::info("Meshified (culled) with {} vertices and {} triangle faces ({} square faces).", vertices.size(),
                  indices.size() / 3, indices.size() / 3 / 2);
@@ -240,54 +696,66 @@ Mesh VoxelGrid::meshify_culled() const
     return Mesh{indices, vertices};
 }
 
-struct Face
+Mesh VoxelGrid::meshify_greedy() const
 {
-    enum class Direction
-    {
-        Front,
-        Back
-    };
-
-    float r, g, b;
-    Direction direction;
-
-    inline bool operator==(const Face &other) const
-    {
-        return std::tie(r, g, b, direction) == std::tie(other.r, other.g, other.b, other.direction);
-    }
-};
+    TRACE_ZONE("Meshify (greedy)");
+    return meshify_greedy_faces(nullptr);
+}
 
-class Mask2D
+Mesh VoxelGrid::meshify_greedy_exterior() const
 {
-  private:
-    std::vector<std::optional<Face>> data;
-
-  public:
-    const unsigned size_u;
-    const unsigned size_v;
+    TRACE_ZONE("Meshify (greedy, exterior)");
+    const ExteriorMask exterior(*this);
+    return meshify_greedy_faces(&exterior);
+}
 
-    inline Mask2D(unsigned size_u, unsigned size_v)
-        : data(size_u * size_v, std::nullopt), size_u(size_u), size_v(size_v)
-    {
-    }
+Mesh VoxelGrid::meshify_greedy_faces(const ExteriorMask *exterior) const
+{
+    return meshify_greedy_masks([&](const unsigned dimension, const unsigned slice, Mask2D &mask) {
+        const unsigned sizes[] = {size_x, size_y, size_z};
+        const unsigned u = (dimension + 1) % 3;
+        const unsigned v = (dimension + 2) % 3;
 
-    inline void enable(const unsigned u, const unsigned v, const Face face)
-    {
-        data[u * size_v + v] = face;
-    }
+        unsigned x[3] = {0, 0, 0};
+        unsigned direction[] = {0, 0, 0};
+        direction[dimension] = 1;
+        x[dimension] = slice;
 
-    inline void disable(const unsigned u, const unsigned v)
-    {
-        data[u * size_v + v] = std::nullopt;
-    }
+        // Walk the slice with x, or else y, innermost, the order rows are stored in.
+        const unsigned inner = std::min(u, v);
+        const unsigned outer = std::max(u, v);
 
-    inline std::optional<Face> get(const unsigned u, const unsigned v)
-    {
-        return data[u * size_v + v];
-    }
-};
+        for (x[outer] = 0; x[outer] < sizes[outer]; ++x[outer])
+        {
+            for (x[inner] = 0; x[inner] < sizes[inner]; ++x[inner])
+            {
+                if (x[dimension] == sizes[dimension] || !get_voxel(x[0], x[1], x[2]).has_value())
+                {
+                    if (get_voxel(x[0] - direction[0], x[1] - direction[1], x[2] - direction[2]).has_value() &&
+                        (!exterior || exterior->is_exterior(x[0], x[1], x[2])))
+                    {
+                        const auto voxel = *get_voxel(x[0] - direction[0], x[1] - direction[1], x[2] - direction[2]);
+                        mask.enable(x[u], x[v], {voxel.r, voxel.g, voxel.b, Face::Direction::Back});
+                    }
+                }
+                else if (get_voxel(x[0], x[1], x[2]).has_value())
+                {
+                    const unsigned behind[] = {x[0] - direction[0], x[1] - direction[1], x[2] - direction[2]};
+                    if ((x[dimension] == 0 || x[dimension] == sizes[dimension] ||
+                         !get_voxel(behind[0], behind[1], behind[2]).has_value()) &&
+                        (!exterior || exterior->is_exterior(behind[0], behind[1], behind[2])))
+                    {
+                        const auto voxel = *get_voxel(x[0], x[1], x[2]);
+                        mask.enable(x[u], x[v], {voxel.r, voxel.g, voxel.b, Face::Direction::Front});
+                    }
+                }
+            }
+        }
+    });
+}
 
-Mesh VoxelGrid::meshify_greedy() const
+Mesh VoxelGrid::meshify_greedy_masks(
+    const std::function<void(unsigned dimension, unsigned slice, Mask2D &mask)> &build_mask) const
 {
     std::vector<Vertex> vertices;
     std::vector<unsigned> indices;
@@ -300,39 +768,19 @@ Mesh VoxelGrid::meshify_greedy() const
         const unsigned v = (dimension + 2) % 3;
 
         unsigned x[3] = {0, 0, 0};
-        unsigned direction[] = {0, 0, 0};
-        direction[dimension] = 1;
 
         for (x[dimension] = 0; x[dimension] <= sizes[dimension]; x[dimension]++)
         {
             Mask2D mask(sizes[u], sizes[v]);
-            spdlog::trace("Iterating dimension {} at {}", dimension, x[dimension]);
+            SPDLOG_TRACE("Iterating dimension {} at {}", dimension, x[dimension]);
 
-            for (x[v] = 0; x[v] < sizes[v]; ++x[v])
             {
-                for (x[u] = 0; x[u] < sizes[u]; ++x[u])
-                {
-                    if (x[dimension] == sizes[dimension] || !get_voxel(x[0], x[1], x[2]).has_value())
-                    {
-                        if (get_voxel(x[0] - direction[0], x[1] - direction[1], x[2] - direction[2]).has_value())
-                        {
-                            const auto voxel =
-                                *get_voxel(x[0] - direction[0], x[1] - direction[1], x[2] - direction[2]);
-                            mask.enable(x[u], x[v], {voxel.r, voxel.g, voxel.b, Face::Direction::Back});
-                        }
-                    }
-                    else if (get_voxel(x[0], x[1], x[2]).has_value())
-                    {
-                        if (x[dimension] == 0 || x[dimension] == sizes[dimension] ||
-                            !get_voxel(x[0] - direction[0], x[1] - direction[1], x[2] - direction[2]).has_value())
-                        {
-                            const auto voxel = *get_voxel(x[0], x[1], x[2]);
-                            mask.enable(x[u], x[v], {voxel.r, voxel.g, voxel.b, Face::Direction::Front});
-                        }
-                    }
-                }
+                PROFILE_ZONE("Build mask");
+                build_mask(dimension, x[dimension], mask);
             }
 
+            PROFILE_ZONE("Merge quads");
+
             for (unsigned temp_v = 0; temp_v < sizes[v]; ++temp_v)
             {
                 for (unsigned temp_u = 0; temp_u < sizes[u]; ++temp_u)
@@ -422,7 +870,7 @@ Mesh VoxelGrid::meshify_greedy() const
                             }
                         }
 
-                        spdlog::trace("Found quad at ({}, {}, {}) width size ({}, {})", x[0], x[1], x[2], w, h);
+                        SPDLOG_TRACE("Found quad at ({}, {}, {}) width size ({}, {})", x[0], x[1], x[2], w, h);
                         temp_u += w - 1;
                     }
                 }
@@ -430,10 +878,12 @@ Mesh VoxelGrid::meshify_greedy() const
         }
     }
 
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
     for (const auto &vertex : vertices)
     {
-        spdlog::trace("Found vertex {} {} {}", vertex.x, vertex.y, vertex.z);
+        SPDLOG_TRACE("Found vertex {} {} {}", vertex.x, vertex.y, vertex.z);
     }
+#endif
 
     spdlog::info("Meshified (greedy) with {} vertices and {} triangle faces ({} square faces).", vertices.size(),
                  indices.size() / 3, indices.size() / 3 / 2);